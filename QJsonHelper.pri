@@ -1,8 +1,43 @@
+QT += concurrent
+
+# Per-class serialization counters (QJsonStats); compiled out when not defined.
+# DEFINES += QJSONHELPER_ENABLE_STATS
+
+# The SSSE3 Base64 codec (QJsonBase64) is picked at run time on x86; building
+# with -mssse3 removes the CPU check.
+# QMAKE_CXXFLAGS += -mssse3
+
 HEADERS += \
+    $$PWD/qjsonbase64.h \
+    $$PWD/qjsonblobstore.h \
+    $$PWD/qjsonbulkloader.h \
+    $$PWD/qjsonconverter.h \
+    $$PWD/qjsonfield.h \
     $$PWD/qjsonhelper.h \
+    $$PWD/qjsonjournal.h \
+    $$PWD/qjsonprojection.h \
+    $$PWD/qjsonstats.h \
+    $$PWD/qjsonstreamreader.h \
+    $$PWD/qjsonstreamwriter.h \
     $$PWD/qobjecthelper.h \
-    $$PWD/qpropertyex.h 
+    $$PWD/qobjecthelper_p.h \
+    $$PWD/qobjectlistwatcher.h \
+    $$PWD/qobjectsink.h \
+    $$PWD/qpropertyex.h \
+    $$PWD/qvariantmapcache.h
 
 SOURCES += \
+    $$PWD/qjsonbase64.cpp \
+    $$PWD/qjsonblobstore.cpp \
+    $$PWD/qjsonbulkloader.cpp \
+    $$PWD/qjsonconverter.cpp \
     $$PWD/qjsonhelper.cpp \
-    $$PWD/qobjecthelper.cpp
+    $$PWD/qjsonjournal.cpp \
+    $$PWD/qjsonprojection.cpp \
+    $$PWD/qjsonstats.cpp \
+    $$PWD/qjsonstreamreader.cpp \
+    $$PWD/qjsonstreamwriter.cpp \
+    $$PWD/qobjecthelper.cpp \
+    $$PWD/qobjectlistwatcher.cpp \
+    $$PWD/qobjectsink.cpp \
+    $$PWD/qvariantmapcache.cpp
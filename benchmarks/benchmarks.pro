@@ -0,0 +1,25 @@
+# QBENCHMARK suite for the serialization and model paths.
+#
+#   qmake && make
+#   ./qjsonhelper_bench -o result.xml,xml      # or -csv, -o result.txt,txt
+#
+# Pass a test function (and optionally :row) to run only that case, e.g.
+# ./qjsonhelper_bench qobject2json:flat100
+
+TEMPLATE = app
+TARGET = qjsonhelper_bench
+
+QT += qml testlib
+QT -= gui
+CONFIG += console c++11 testcase
+CONFIG -= app_bundle
+
+include(../QJsonHelper.pri)
+
+INCLUDEPATH += $$PWD/..
+
+HEADERS += \
+    $$PWD/models.h
+
+SOURCES += \
+    $$PWD/tst_qjsonhelperbench.cpp
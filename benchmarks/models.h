@@ -0,0 +1,176 @@
+#ifndef BENCHMARK_MODELS_H
+#define BENCHMARK_MODELS_H
+
+#include <QtCore/QByteArray>
+#include <QtCore/QString>
+
+#include "qjsonhelper.h"
+#include "qpropertyex.h"
+
+/*
+* Synthetic models for the benchmarks. Property names encode their type
+* (i: int, d: double, s: QString, b: bool) so fill() can populate any of
+* them generically.
+*/
+
+class Flat10 : public QJsonHelper {
+    Q_OBJECT
+    Q_PROPERTY_AUTO(int, i00)
+    Q_PROPERTY_AUTO(double, d01)
+    Q_PROPERTY_AUTO(QString, s02)
+    Q_PROPERTY_AUTO(bool, b03)
+    Q_PROPERTY_AUTO(int, i04)
+    Q_PROPERTY_AUTO(double, d05)
+    Q_PROPERTY_AUTO(QString, s06)
+    Q_PROPERTY_AUTO(bool, b07)
+    Q_PROPERTY_AUTO(int, i08)
+    Q_PROPERTY_AUTO(double, d09)
+public:
+    Q_INVOKABLE explicit Flat10(QObject *parent = nullptr) : QJsonHelper(parent) {}
+};
+
+class Flat100 : public QJsonHelper {
+    Q_OBJECT
+    Q_PROPERTY_AUTO(int, i00)
+    Q_PROPERTY_AUTO(double, d01)
+    Q_PROPERTY_AUTO(QString, s02)
+    Q_PROPERTY_AUTO(bool, b03)
+    Q_PROPERTY_AUTO(int, i04)
+    Q_PROPERTY_AUTO(double, d05)
+    Q_PROPERTY_AUTO(QString, s06)
+    Q_PROPERTY_AUTO(bool, b07)
+    Q_PROPERTY_AUTO(int, i08)
+    Q_PROPERTY_AUTO(double, d09)
+    Q_PROPERTY_AUTO(QString, s10)
+    Q_PROPERTY_AUTO(bool, b11)
+    Q_PROPERTY_AUTO(int, i12)
+    Q_PROPERTY_AUTO(double, d13)
+    Q_PROPERTY_AUTO(QString, s14)
+    Q_PROPERTY_AUTO(bool, b15)
+    Q_PROPERTY_AUTO(int, i16)
+    Q_PROPERTY_AUTO(double, d17)
+    Q_PROPERTY_AUTO(QString, s18)
+    Q_PROPERTY_AUTO(bool, b19)
+    Q_PROPERTY_AUTO(int, i20)
+    Q_PROPERTY_AUTO(double, d21)
+    Q_PROPERTY_AUTO(QString, s22)
+    Q_PROPERTY_AUTO(bool, b23)
+    Q_PROPERTY_AUTO(int, i24)
+    Q_PROPERTY_AUTO(double, d25)
+    Q_PROPERTY_AUTO(QString, s26)
+    Q_PROPERTY_AUTO(bool, b27)
+    Q_PROPERTY_AUTO(int, i28)
+    Q_PROPERTY_AUTO(double, d29)
+    Q_PROPERTY_AUTO(QString, s30)
+    Q_PROPERTY_AUTO(bool, b31)
+    Q_PROPERTY_AUTO(int, i32)
+    Q_PROPERTY_AUTO(double, d33)
+    Q_PROPERTY_AUTO(QString, s34)
+    Q_PROPERTY_AUTO(bool, b35)
+    Q_PROPERTY_AUTO(int, i36)
+    Q_PROPERTY_AUTO(double, d37)
+    Q_PROPERTY_AUTO(QString, s38)
+    Q_PROPERTY_AUTO(bool, b39)
+    Q_PROPERTY_AUTO(int, i40)
+    Q_PROPERTY_AUTO(double, d41)
+    Q_PROPERTY_AUTO(QString, s42)
+    Q_PROPERTY_AUTO(bool, b43)
+    Q_PROPERTY_AUTO(int, i44)
+    Q_PROPERTY_AUTO(double, d45)
+    Q_PROPERTY_AUTO(QString, s46)
+    Q_PROPERTY_AUTO(bool, b47)
+    Q_PROPERTY_AUTO(int, i48)
+    Q_PROPERTY_AUTO(double, d49)
+    Q_PROPERTY_AUTO(QString, s50)
+    Q_PROPERTY_AUTO(bool, b51)
+    Q_PROPERTY_AUTO(int, i52)
+    Q_PROPERTY_AUTO(double, d53)
+    Q_PROPERTY_AUTO(QString, s54)
+    Q_PROPERTY_AUTO(bool, b55)
+    Q_PROPERTY_AUTO(int, i56)
+    Q_PROPERTY_AUTO(double, d57)
+    Q_PROPERTY_AUTO(QString, s58)
+    Q_PROPERTY_AUTO(bool, b59)
+    Q_PROPERTY_AUTO(int, i60)
+    Q_PROPERTY_AUTO(double, d61)
+    Q_PROPERTY_AUTO(QString, s62)
+    Q_PROPERTY_AUTO(bool, b63)
+    Q_PROPERTY_AUTO(int, i64)
+    Q_PROPERTY_AUTO(double, d65)
+    Q_PROPERTY_AUTO(QString, s66)
+    Q_PROPERTY_AUTO(bool, b67)
+    Q_PROPERTY_AUTO(int, i68)
+    Q_PROPERTY_AUTO(double, d69)
+    Q_PROPERTY_AUTO(QString, s70)
+    Q_PROPERTY_AUTO(bool, b71)
+    Q_PROPERTY_AUTO(int, i72)
+    Q_PROPERTY_AUTO(double, d73)
+    Q_PROPERTY_AUTO(QString, s74)
+    Q_PROPERTY_AUTO(bool, b75)
+    Q_PROPERTY_AUTO(int, i76)
+    Q_PROPERTY_AUTO(double, d77)
+    Q_PROPERTY_AUTO(QString, s78)
+    Q_PROPERTY_AUTO(bool, b79)
+    Q_PROPERTY_AUTO(int, i80)
+    Q_PROPERTY_AUTO(double, d81)
+    Q_PROPERTY_AUTO(QString, s82)
+    Q_PROPERTY_AUTO(bool, b83)
+    Q_PROPERTY_AUTO(int, i84)
+    Q_PROPERTY_AUTO(double, d85)
+    Q_PROPERTY_AUTO(QString, s86)
+    Q_PROPERTY_AUTO(bool, b87)
+    Q_PROPERTY_AUTO(int, i88)
+    Q_PROPERTY_AUTO(double, d89)
+    Q_PROPERTY_AUTO(QString, s90)
+    Q_PROPERTY_AUTO(bool, b91)
+    Q_PROPERTY_AUTO(int, i92)
+    Q_PROPERTY_AUTO(double, d93)
+    Q_PROPERTY_AUTO(QString, s94)
+    Q_PROPERTY_AUTO(bool, b95)
+    Q_PROPERTY_AUTO(int, i96)
+    Q_PROPERTY_AUTO(double, d97)
+    Q_PROPERTY_AUTO(QString, s98)
+    Q_PROPERTY_AUTO(bool, b99)
+public:
+    Q_INVOKABLE explicit Flat100(QObject *parent = nullptr) : QJsonHelper(parent) {}
+};
+
+// Binary tree of QObject* properties, each node carrying a
+// Q_PROPERTY_QML child.
+class TreeNode : public QJsonHelper {
+    Q_OBJECT
+    Q_PROPERTY_AUTO(QString, label)
+    Q_PROPERTY_AUTO(int, value)
+    Q_PROPERTY_QML(Flat10, details)
+    Q_PROPERTY_AUTO_P(TreeNode*, left)
+    Q_PROPERTY_AUTO_P(TreeNode*, right)
+public:
+    Q_INVOKABLE explicit TreeNode(QObject *parent = nullptr) : QJsonHelper(parent) {}
+};
+
+class BlobModel : public QJsonHelper {
+    Q_OBJECT
+    Q_PROPERTY_AUTO(QString, name)
+    Q_PROPERTY_AUTO(QByteArray, data)
+public:
+    Q_INVOKABLE explicit BlobModel(QObject *parent = nullptr) : QJsonHelper(parent) {}
+};
+
+class Row : public QJsonHelper {
+    Q_OBJECT
+    Q_PROPERTY_AUTO(int, id)
+    Q_PROPERTY_AUTO(QString, title)
+    Q_PROPERTY_AUTO(double, score)
+    Q_PROPERTY_AUTO(bool, done)
+public:
+    Q_INVOKABLE explicit Row(QObject *parent = nullptr) : QJsonHelper(parent) {}
+};
+
+class RowList : public QJsonHelper {
+    Q_OBJECT
+    Q_PROPERTY_QMLLIST(Row, rows)
+public:
+    Q_INVOKABLE explicit RowList(QObject *parent = nullptr) : QJsonHelper(parent) {}
+};
+
+#endif // BENCHMARK_MODELS_H
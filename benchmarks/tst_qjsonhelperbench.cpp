@@ -0,0 +1,509 @@
+#include <QtCore/QJsonArray>
+#include <QtCore/QFileInfo>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QMetaProperty>
+#include <QtCore/QScopedPointer>
+#include <QtCore/QTemporaryDir>
+#include <QtTest/QtTest>
+
+#include "models.h"
+#include "qobjecthelper.h"
+
+namespace {
+
+// Sets every property declared below QJsonHelper from its name (see
+// models.h) and @p seed.
+void fill(QObject *object, int seed)
+{
+    const QMetaObject *metaobject = object->metaObject();
+    for (int i = QJsonHelper::staticMetaObject.propertyCount(); i < metaobject->propertyCount(); ++i) {
+        const QMetaProperty property = metaobject->property(i);
+        const int n = seed + i;
+        switch (property.name()[0]) {
+        case 'i': property.write(object, n); break;
+        case 'd': property.write(object, n * 0.25); break;
+        case 's': property.write(object, QStringLiteral("value %1 of the property").arg(n)); break;
+        case 'b': property.write(object, n % 2 == 0); break;
+        default: break;
+        }
+    }
+}
+
+TreeNode *buildTree(int depth, QObject *parent, int &counter)
+{
+    TreeNode *node = new TreeNode(parent);
+    node->setlabel(QStringLiteral("node %1").arg(counter));
+    node->setvalue(counter++);
+    node->getdetails();     // creates the Q_PROPERTY_QML child
+    fill(node->detailsObject(), counter);
+    if (depth > 1) {
+        node->left(buildTree(depth - 1, node, counter));
+        node->right(buildTree(depth - 1, node, counter));
+    }
+    return node;
+}
+
+QByteArray blobData(int size)
+{
+    QByteArray data(size, Qt::Uninitialized);
+    for (int i = 0; i < size; ++i)
+        data[i] = char(i * 31 + 7);
+    return data;
+}
+
+QJsonArray rowsJson(int count)
+{
+    QJsonArray rows;
+    for (int i = 0; i < count; ++i) {
+        QJsonObject row;
+        row.insert(QStringLiteral("id"), i);
+        row.insert(QStringLiteral("title"), QStringLiteral("row %1").arg(i));
+        row.insert(QStringLiteral("score"), i * 0.5);
+        row.insert(QStringLiteral("done"), i % 3 == 0);
+        rows.append(row);
+    }
+    return rows;
+}
+
+// One of the models by name, populated; owned by the caller.
+QObject *createModel(const QString &model)
+{
+    if (model == QLatin1String("flat10")) {
+        Flat10 *object = new Flat10;
+        fill(object, 0);
+        return object;
+    }
+    if (model == QLatin1String("flat100")) {
+        Flat100 *object = new Flat100;
+        fill(object, 0);
+        return object;
+    }
+    if (model == QLatin1String("nested")) {
+        int counter = 0;
+        return buildTree(6, nullptr, counter);      // 63 nodes
+    }
+    if (model.startsWith(QLatin1String("blob"))) {
+        BlobModel *object = new BlobModel;
+        object->setname(model);
+        object->setdata(blobData(model == QLatin1String("blob1k") ? 1024 : 1024 * 1024));
+        return object;
+    }
+    if (model.startsWith(QLatin1String("list"))) {
+        RowList *object = new RowList;
+        object->setrows(rowsJson(model == QLatin1String("list1k") ? 1000 : 100000));
+        return object;
+    }
+    return nullptr;
+}
+
+void addModelRows()
+{
+    QTest::addColumn<QString>("model");
+    const char *models[] = { "flat10", "flat100", "nested", "blob1k", "blob1m", "list1k", "list100k" };
+    for (const char *model : models)
+        QTest::newRow(model) << QString::fromLatin1(model);
+}
+
+// The per-call property walk that QPropertyPlan replaced: every property
+// is looked up and filtered again on each call.
+QJsonObject reflectiveRead(const QObject *object, const QStringList &ignoredProperties)
+{
+    QJsonObject json;
+    const QMetaObject *metaobject = object->metaObject();
+    for (int i = 0; i < metaobject->propertyCount(); ++i) {
+        const QMetaProperty property = metaobject->property(i);
+        const QString name = QString::fromLatin1(property.name());
+        if (!property.isReadable() || ignoredProperties.contains(name))
+            continue;
+        json.insert(name, QJsonValue::fromVariant(property.read(object)));
+    }
+    return json;
+}
+
+void reflectiveWrite(const QJsonObject &json, QObject *object)
+{
+    const QMetaObject *metaobject = object->metaObject();
+    for (QJsonObject::const_iterator it = json.constBegin(); it != json.constEnd(); ++it) {
+        const int index = metaobject->indexOfProperty(it.key().toLatin1().constData());
+        if (index < 0)
+            continue;
+        const QMetaProperty property = metaobject->property(index);
+        if (property.isWritable())
+            property.write(object, it.value().toVariant());
+    }
+}
+
+void addPlanRows()
+{
+    QTest::addColumn<QString>("model");
+    QTest::addColumn<bool>("plan");
+    const char *models[] = { "flat10", "flat100" };
+    for (const char *model : models) {
+        QTest::newRow(QByteArray(model).append("/uncached").constData()) << QString::fromLatin1(model) << false;
+        QTest::newRow(QByteArray(model).append("/plan").constData()) << QString::fromLatin1(model) << true;
+    }
+}
+
+void addFormatRows()
+{
+    QTest::addColumn<QString>("model");
+    QTest::addColumn<bool>("cbor");
+    const char *models[] = { "flat100", "nested", "blob1m", "list100k" };
+    for (const char *model : models) {
+        QTest::newRow(QByteArray(model).append("/json").constData()) << QString::fromLatin1(model) << false;
+        QTest::newRow(QByteArray(model).append("/cbor").constData()) << QString::fromLatin1(model) << true;
+    }
+}
+
+void addListRows()
+{
+    QTest::addColumn<int>("count");
+    QTest::newRow("1k") << 1000;
+    QTest::newRow("100k") << 100000;
+}
+
+} // namespace
+
+class tst_QJsonHelperBench : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    // QObject -> JSON / QVariantMap
+    void qobject2json_data() { addModelRows(); }
+    void qobject2json();
+    void qobject2variantmap_data() { addModelRows(); }
+    void qobject2variantmap();
+
+    // JSON / QVariantMap -> QObject
+    void json2qobject_data() { addModelRows(); }
+    void json2qobject();
+    void fromVariantMap_data() { addModelRows(); }
+    void fromVariantMap();
+
+    // files
+    void save_data() { addModelRows(); }
+    void save();
+    void load_data() { addModelRows(); }
+    void load();
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+    // saveBinary()/loadBinary() against save()/load()
+    void formatSave_data() { addFormatRows(); }
+    void formatSave();
+    void formatLoad_data() { addFormatRows(); }
+    void formatLoad();
+    void formatSize_data() { addFormatRows(); }
+    void formatSize();
+#endif
+
+    // property plan cache against a plain QMetaObject walk
+    void planRead_data() { addPlanRows(); }
+    void planRead();
+    void planWrite_data() { addPlanRows(); }
+    void planWrite();
+
+    // rebuilding 50k rows from QVariantMaps
+    void variantRebuild_data();
+    void variantRebuild();
+
+    // Q_PROPERTY_QMLLIST invokables
+    void listDeserialization_data() { addListRows(); }
+    void listDeserialization();
+    void listSerialization_data() { addListRows(); }
+    void listSerialization();
+    void listAppendRemove_data() { addListRows(); }
+    void listAppendRemove();
+    void listInsertRemoveFront_data() { addListRows(); }
+    void listInsertRemoveFront();
+    void listSetAt_data() { addListRows(); }
+    void listSetAt();
+    void listGetAt_data() { addListRows(); }
+    void listGetAt();
+    void listIndexOf_data() { addListRows(); }
+    void listIndexOf();
+};
+
+void tst_QJsonHelperBench::qobject2json()
+{
+    QFETCH(QString, model);
+    QScopedPointer<QObject> object(createModel(model));
+    QBENCHMARK {
+        QObjectHelper::qobject2json(object.data());
+    }
+}
+
+void tst_QJsonHelperBench::qobject2variantmap()
+{
+    QFETCH(QString, model);
+    QScopedPointer<QObject> object(createModel(model));
+    QBENCHMARK {
+        QObjectHelper::qobject2variantmap(object.data());
+    }
+}
+
+void tst_QJsonHelperBench::json2qobject()
+{
+    QFETCH(QString, model);
+    QScopedPointer<QObject> source(createModel(model));
+    QScopedPointer<QObject> target(createModel(model));
+    const QByteArray json = QObjectHelper::qobject2json(source.data()).toUtf8();
+    QBENCHMARK {
+        QObjectHelper::json2qobject(json, target.data());
+    }
+}
+
+void tst_QJsonHelperBench::fromVariantMap()
+{
+    QFETCH(QString, model);
+    QScopedPointer<QObject> source(createModel(model));
+    QScopedPointer<QObject> target(createModel(model));
+    const QVariantMap map = QObjectHelper::qobject2variantmap(source.data());
+    QJsonHelper *helper = qobject_cast<QJsonHelper *>(target.data());
+    QBENCHMARK {
+        helper->fromVariantMap(map);
+    }
+}
+
+void tst_QJsonHelperBench::save()
+{
+    QFETCH(QString, model);
+    QScopedPointer<QObject> object(createModel(model));
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fpath = dir.filePath(model + QStringLiteral(".json"));
+    QBENCHMARK {
+        QJsonHelper::save(object.data(), fpath);
+    }
+}
+
+void tst_QJsonHelperBench::load()
+{
+    QFETCH(QString, model);
+    QScopedPointer<QObject> source(createModel(model));
+    QScopedPointer<QObject> target(createModel(model));
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fpath = dir.filePath(model + QStringLiteral(".json"));
+    QVERIFY(QJsonHelper::save(source.data(), fpath));
+    QBENCHMARK {
+        QJsonHelper::load(fpath, target.data());
+    }
+}
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+void tst_QJsonHelperBench::formatSave()
+{
+    QFETCH(QString, model);
+    QFETCH(bool, cbor);
+    QScopedPointer<QObject> object(createModel(model));
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fpath = dir.filePath(model);
+    if (cbor) {
+        QBENCHMARK {
+            QJsonHelper::saveBinary(object.data(), fpath);
+        }
+    } else {
+        QBENCHMARK {
+            QJsonHelper::save(object.data(), fpath);
+        }
+    }
+}
+
+void tst_QJsonHelperBench::formatLoad()
+{
+    QFETCH(QString, model);
+    QFETCH(bool, cbor);
+    QScopedPointer<QObject> source(createModel(model));
+    QScopedPointer<QObject> target(createModel(model));
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fpath = dir.filePath(model);
+    QVERIFY(cbor ? QJsonHelper::saveBinary(source.data(), fpath) : QJsonHelper::save(source.data(), fpath));
+    QBENCHMARK {
+        QJsonHelper::load(fpath, target.data());    // detects the format
+    }
+}
+
+// Reports the file size instead of a time, so it lands in the same
+// machine-readable output.
+void tst_QJsonHelperBench::formatSize()
+{
+    QFETCH(QString, model);
+    QFETCH(bool, cbor);
+    QScopedPointer<QObject> object(createModel(model));
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fpath = dir.filePath(model);
+    QVERIFY(cbor ? QJsonHelper::saveBinary(object.data(), fpath) : QJsonHelper::save(object.data(), fpath));
+    QTest::setBenchmarkResult(QFileInfo(fpath).size(), QTest::BytesAllocated);
+}
+#endif
+
+void tst_QJsonHelperBench::planRead()
+{
+    QFETCH(QString, model);
+    QFETCH(bool, plan);
+    QScopedPointer<QObject> object(createModel(model));
+    const QStringList ignored(QStringLiteral("objectName"));
+    if (plan) {
+        QBENCHMARK {
+            QObjectHelper::qobject2qjsonobject(object.data(), ignored);
+        }
+    } else {
+        QBENCHMARK {
+            reflectiveRead(object.data(), ignored);
+        }
+    }
+}
+
+void tst_QJsonHelperBench::planWrite()
+{
+    QFETCH(QString, model);
+    QFETCH(bool, plan);
+    QScopedPointer<QObject> source(createModel(model));
+    QScopedPointer<QObject> target(createModel(model));
+    const QJsonObject json = QObjectHelper::qobject2qjsonobject(source.data());
+    if (plan) {
+        QBENCHMARK {
+            QObjectHelper::qjsonobject2qobject(json, target.data());
+        }
+    } else {
+        QBENCHMARK {
+            reflectiveWrite(json, target.data());
+        }
+    }
+}
+
+void tst_QJsonHelperBench::variantRebuild_data()
+{
+    QTest::addColumn<QString>("path");
+    QTest::newRow("direct") << QStringLiteral("direct");
+    QTest::newRow("textRoundTrip") << QStringLiteral("textRoundTrip");
+    QTest::newRow("qmllist") << QStringLiteral("qmllist");
+}
+
+// 50k rows populated from QVariantMaps: qvariantmap2qobject, the JSON text
+// round trip fromVariantMap() used to take, and a whole Q_PROPERTY_QMLLIST
+// rebuild (which goes through the direct path per row).
+void tst_QJsonHelperBench::variantRebuild()
+{
+    QFETCH(QString, path);
+    const int count = 50000;
+    const QJsonArray json = rowsJson(count);
+
+    if (path == QLatin1String("qmllist")) {
+        QBENCHMARK {
+            RowList list;
+            list.setrows(json);
+        }
+        return;
+    }
+
+    QVector<QVariantMap> maps;
+    maps.reserve(count);
+    for (const QJsonValue &row : json)
+        maps.append(row.toObject().toVariantMap());
+    QObject parent;
+    QVector<Row *> rows;
+    rows.reserve(count);
+    for (int i = 0; i < count; ++i)
+        rows.append(new Row(&parent));
+
+    if (path == QLatin1String("direct")) {
+        QBENCHMARK {
+            for (int i = 0; i < count; ++i)
+                QObjectHelper::qvariantmap2qobject(maps.at(i), rows.at(i));
+        }
+    } else {
+        QBENCHMARK {
+            for (int i = 0; i < count; ++i) {
+                const QByteArray text = QJsonDocument(QJsonObject::fromVariantMap(maps.at(i))).toJson(QJsonDocument::Compact);
+                QObjectHelper::json2qobject(text, rows.at(i));
+            }
+        }
+    }
+}
+
+void tst_QJsonHelperBench::listDeserialization()
+{
+    QFETCH(int, count);
+    const QJsonArray json = rowsJson(count);
+    QBENCHMARK {
+        RowList list;           // the setter skips arrays equal to the current one
+        list.setrows(json);
+    }
+}
+
+void tst_QJsonHelperBench::listSerialization()
+{
+    QFETCH(int, count);
+    RowList list;
+    list.setrows(rowsJson(count));
+    QBENCHMARK {
+        list.rowsSerialization();
+    }
+}
+
+void tst_QJsonHelperBench::listAppendRemove()
+{
+    QFETCH(int, count);
+    RowList list;
+    list.setrows(rowsJson(count));
+    const QVariantMap row = rowsJson(1).at(0).toObject().toVariantMap();
+    QBENCHMARK {
+        list.rowsAppend(row);
+        list.rowsRemove(count);
+    }
+}
+
+void tst_QJsonHelperBench::listInsertRemoveFront()
+{
+    QFETCH(int, count);
+    RowList list;
+    list.setrows(rowsJson(count));
+    const QVariantMap row = rowsJson(1).at(0).toObject().toVariantMap();
+    QBENCHMARK {
+        list.rowsInsert(0, row);
+        list.rowsRemove(0);
+    }
+}
+
+void tst_QJsonHelperBench::listSetAt()
+{
+    QFETCH(int, count);
+    RowList list;
+    list.setrows(rowsJson(count));
+    QVariantMap row = list.rowsGetAt(count / 2);
+    int i = 0;
+    QBENCHMARK {
+        row.insert(QStringLiteral("score"), ++i);
+        list.rowsSetAt(count / 2, row);
+    }
+}
+
+void tst_QJsonHelperBench::listGetAt()
+{
+    QFETCH(int, count);
+    RowList list;
+    list.setrows(rowsJson(count));
+    QBENCHMARK {
+        list.rowsGetAt(count / 2);
+    }
+}
+
+void tst_QJsonHelperBench::listIndexOf()
+{
+    QFETCH(int, count);
+    RowList list;
+    list.setrows(rowsJson(count));
+    const QVariantMap last = list.rowsGetAt(count - 1);
+    QBENCHMARK {
+        list.rowsIndexOf(last);
+    }
+}
+
+QTEST_MAIN(tst_QJsonHelperBench)
+
+#include "tst_qjsonhelperbench.moc"
@@ -0,0 +1,281 @@
+﻿#include "qjsonbase64.h"
+
+#include "qjsonstats.h"
+
+#include <cstring>
+
+// The SSSE3 blocks are always built on x86. Without -mssse3 they are compiled
+// for that target alone and only run when the CPU reports SSSE3.
+#if defined(__SSSE3__)
+#  define QJSONBASE64_SSSE3
+#  define QJSONBASE64_TARGET
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#  define QJSONBASE64_SSSE3
+#  define QJSONBASE64_SSSE3_RUNTIME
+#  define QJSONBASE64_TARGET __attribute__((target("ssse3")))
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#  define QJSONBASE64_SSSE3
+#  define QJSONBASE64_SSSE3_RUNTIME
+#  define QJSONBASE64_TARGET
+#  include <intrin.h>
+#endif
+
+#if defined(QJSONBASE64_SSSE3)
+#include <tmmintrin.h>
+#endif
+
+namespace {
+
+const char EncodeTable[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+const signed char DecodeTable[128] = {
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 62, -1, -1, -1, 63,
+    52, 53, 54, 55, 56, 57, 58, 59, 60, 61, -1, -1, -1, -1, -1, -1,
+    -1,  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14,
+    15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, -1, -1, -1, -1, -1,
+    -1, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+    41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, -1, -1, -1, -1, -1
+};
+
+inline int decodeChar(uint c)
+{
+    return c < 128 ? DecodeTable[c] : -1;
+}
+
+#if defined(QJSONBASE64_SSSE3)
+bool cpuHasSsse3()
+{
+#if !defined(QJSONBASE64_SSSE3_RUNTIME)
+    return true;
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 9)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("ssse3");
+#endif
+}
+
+inline bool useSsse3()
+{
+    static const bool supported = cpuHasSsse3();
+    return supported;
+}
+
+// 12 input bytes (of the 16 loaded) -> 16 output characters.
+QJSONBASE64_TARGET inline __m128i encodeBlock(__m128i input)
+{
+    // split into 6 bit indices, one per byte
+    const __m128i in = _mm_shuffle_epi8(input, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7,
+                                                            4, 5, 3, 4, 1, 2, 0, 1));
+    const __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+    const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+    const __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+    const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+    const __m128i indices = _mm_or_si128(t1, t3);
+
+    // index -> offset to its character: 0..25 'A', 26..51 'a', 52..61 '0', 62 '+', 63 '/'
+    const __m128i offsets = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                          '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                          '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+    __m128i slot = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+    const __m128i upper = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+    slot = _mm_or_si128(slot, _mm_and_si128(upper, _mm_set1_epi8(13)));
+    return _mm_add_epi8(indices, _mm_shuffle_epi8(offsets, slot));
+}
+
+QJSONBASE64_TARGET inline __m128i inRange(__m128i c, char lo, char hi)
+{
+    return _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8(char(lo - 1))),
+                         _mm_cmplt_epi8(c, _mm_set1_epi8(char(hi + 1))));
+}
+
+// 16 characters -> 12 bytes. Returns false when one of the characters is
+// not in the Base64 alphabet (padding included); the caller then decodes
+// the block with the scalar loop.
+QJSONBASE64_TARGET inline bool decodeBlock(__m128i c, uchar *out)
+{
+    const __m128i upper = inRange(c, 'A', 'Z');
+    const __m128i lower = inRange(c, 'a', 'z');
+    const __m128i digit = inRange(c, '0', '9');
+    const __m128i plus = _mm_cmpeq_epi8(c, _mm_set1_epi8('+'));
+    const __m128i slash = _mm_cmpeq_epi8(c, _mm_set1_epi8('/'));
+    const __m128i valid = _mm_or_si128(_mm_or_si128(upper, lower),
+                                       _mm_or_si128(digit, _mm_or_si128(plus, slash)));
+    if (_mm_movemask_epi8(valid) != 0xffff)
+        return false;
+
+    __m128i shift = _mm_and_si128(upper, _mm_set1_epi8(-65));
+    shift = _mm_or_si128(shift, _mm_and_si128(lower, _mm_set1_epi8(-71)));
+    shift = _mm_or_si128(shift, _mm_and_si128(digit, _mm_set1_epi8(4)));
+    shift = _mm_or_si128(shift, _mm_and_si128(plus, _mm_set1_epi8(19)));
+    shift = _mm_or_si128(shift, _mm_and_si128(slash, _mm_set1_epi8(16)));
+    const __m128i values = _mm_add_epi8(c, shift);
+
+    // pack 4 x 6 bits into 3 bytes per 32 bit lane
+    const __m128i pairs = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+    const __m128i lanes = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+    const __m128i bytes = _mm_shuffle_epi8(lanes, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8,
+                                                                14, 13, 12, -1, -1, -1, -1));
+    char block[16];
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(block), bytes);
+    std::memcpy(out, block, 12);
+    return true;
+}
+
+QJSONBASE64_TARGET inline __m128i load16(const char *text)
+{
+    return _mm_loadu_si128(reinterpret_cast<const __m128i *>(text));
+}
+
+QJSONBASE64_TARGET inline __m128i load16(const ushort *text)
+{
+    // characters above 0xff saturate to 0xff (or 0 when >= 0x8000),
+    // both outside the alphabet
+    const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text));
+    const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text + 8));
+    return _mm_packus_epi16(lo, hi);
+}
+
+// Encodes whole blocks while 16 bytes can be read; returns the bytes consumed.
+QJSONBASE64_TARGET int encodeBlocks(const uchar *src, int size, char *out)
+{
+    // each step reads 16 bytes and consumes 12
+    int i = 0;
+    for (; i + 16 <= size; i += 12, out += 16) {
+        const __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out), encodeBlock(input));
+    }
+    return i;
+}
+
+// Decodes whole blocks up to the first one holding a character outside the
+// alphabet; returns the characters consumed.
+template <typename Char>
+QJSONBASE64_TARGET int decodeBlocks(const Char *text, int n, uchar *dst)
+{
+    int i = 0;
+    for (; i + 16 <= n; i += 16, dst += 12) {
+        if (!decodeBlock(load16(text + i), dst))
+            break;
+    }
+    return i;
+}
+#endif
+
+void encodeBytes(const uchar *src, int size, char *out)
+{
+    int i = 0;
+#if defined(QJSONBASE64_SSSE3)
+    if (useSsse3()) {
+        i = encodeBlocks(src, size, out);
+        out += i / 3 * 4;
+    }
+#endif
+    for (; i + 3 <= size; i += 3) {
+        const uint n = (uint(src[i]) << 16) | (uint(src[i + 1]) << 8) | src[i + 2];
+        *out++ = EncodeTable[n >> 18];
+        *out++ = EncodeTable[(n >> 12) & 0x3f];
+        *out++ = EncodeTable[(n >> 6) & 0x3f];
+        *out++ = EncodeTable[n & 0x3f];
+    }
+    if (i < size) {
+        const uint n = (uint(src[i]) << 16) | (i + 1 < size ? uint(src[i + 1]) << 8 : 0);
+        *out++ = EncodeTable[n >> 18];
+        *out++ = EncodeTable[(n >> 12) & 0x3f];
+        *out++ = i + 1 < size ? EncodeTable[(n >> 6) & 0x3f] : '=';
+        *out++ = '=';
+    }
+}
+
+template <typename Char>
+bool decodeChars(const Char *text, int size, QByteArray *out)
+{
+    // up to two '=' of padding, which may also be left out
+    int n = size;
+    if (n > 0 && text[n - 1] == Char('='))
+        --n;
+    if (n > 0 && text[n - 1] == Char('='))
+        --n;
+    if (n % 4 == 1 || (n < size && size % 4 != 0))
+        return false;
+
+    out->resize(n / 4 * 3 + (n % 4 ? n % 4 - 1 : 0));
+    uchar *dst = reinterpret_cast<uchar *>(out->data());
+
+    int i = 0;
+#if defined(QJSONBASE64_SSSE3)
+    if (useSsse3()) {
+        i = decodeBlocks(text, n, dst);
+        dst += i / 4 * 3;
+    }
+#endif
+    for (; i + 4 <= n; i += 4) {
+        const int a = decodeChar(text[i]);
+        const int b = decodeChar(text[i + 1]);
+        const int c = decodeChar(text[i + 2]);
+        const int d = decodeChar(text[i + 3]);
+        if ((a | b | c | d) < 0)
+            return false;
+        const uint v = (uint(a) << 18) | (uint(b) << 12) | (uint(c) << 6) | uint(d);
+        *dst++ = uchar(v >> 16);
+        *dst++ = uchar(v >> 8);
+        *dst++ = uchar(v);
+    }
+    if (i < n) {
+        const int a = decodeChar(text[i]);
+        const int b = decodeChar(text[i + 1]);
+        const int c = i + 2 < n ? decodeChar(text[i + 2]) : 0;
+        if ((a | b | c) < 0)
+            return false;
+        const uint v = (uint(a) << 18) | (uint(b) << 12) | (uint(c) << 6);
+        *dst++ = uchar(v >> 16);
+        if (i + 2 < n)
+            *dst++ = uchar(v >> 8);
+    }
+    return true;
+}
+
+} // namespace
+
+void QJsonBase64::encode(const char *data, int size, char *out)
+{
+    encodeBytes(reinterpret_cast<const uchar *>(data), size, out);
+}
+
+QByteArray QJsonBase64::encode(const QByteArray &data)
+{
+    QByteArray out(encodedLength(data.size()), Qt::Uninitialized);
+    encode(data.constData(), data.size(), out.data());
+    return out;
+}
+
+QString QJsonBase64::encodeToString(const QByteArray &data)
+{
+    return QString::fromLatin1(encode(data));
+}
+
+bool QJsonBase64::decode(const char *text, int size, QByteArray *out)
+{
+    return decodeChars(text, size, out);
+}
+
+bool QJsonBase64::decode(const QString &text, QByteArray *out)
+{
+    return decodeChars(text.utf16(), text.size(), out);
+}
+
+QByteArray QJsonBase64::fromText(const QString &text)
+{
+    QByteArray out;
+    if (decode(text, &out))
+        return out;
+    // 去掉可能的空白 / 换行（防御性）
+    out = QByteArray::fromBase64(text.toLatin1(), QByteArray::Base64Encoding);
+    if (out.isEmpty() && !text.isEmpty())
+        qCWarning(lcQJsonHelper) << "Base64 decode failed";
+    return out;
+}
@@ -0,0 +1,40 @@
+﻿#ifndef QJSONBASE64_H
+#define QJSONBASE64_H
+
+#include <QtCore/QByteArray>
+#include <QtCore/QString>
+
+/**
+* @brief Standard Base64 (RFC 4648, with padding) used for QByteArray
+* properties.
+*
+* Encoding writes straight into a caller provided buffer, so
+* QJsonStreamWriter formats blobs in its output buffer without a temporary
+* copy. Decoding reads a QString's UTF-16 data directly instead of going
+* through a Latin-1 or UTF-8 copy first. On x86 both use SSSE3 when the CPU
+* supports it, checked once at run time (builds with -mssse3 or
+* -march=native skip the check), and a table driven loop otherwise.
+*
+* decode() is strict: it fails on whitespace, the URL alphabet or bad
+* padding; fromText() falls back to QByteArray::fromBase64() for such input.
+*/
+class QJsonBase64 {
+public:
+    static int encodedLength(int size) {
+        return (size + 2) / 3 * 4;
+    }
+
+    // @p out must have room for encodedLength(size) bytes.
+    static void encode(const char *data, int size, char *out);
+    static QByteArray encode(const QByteArray &data);
+    static QString encodeToString(const QByteArray &data);
+
+    static bool decode(const char *text, int size, QByteArray *out);
+    static bool decode(const QString &text, QByteArray *out);
+
+    // decode(), falling back to QByteArray::fromBase64() for input it
+    // rejects. Logs a warning when nothing could be decoded.
+    static QByteArray fromText(const QString &text);
+};
+
+#endif // QJSONBASE64_H
@@ -0,0 +1,125 @@
+﻿#include "qjsonblobstore.h"
+
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QSaveFile>
+
+#include "qjsonstats.h"
+
+namespace {
+
+const QLatin1String BlobKey("$blob");
+const QLatin1String SizeKey("size");
+
+thread_local QJsonBlobStore *currentStore = nullptr;
+
+// Blob names come from the document; only accept plain file names.
+bool isBlobName(const QString &name)
+{
+    return !name.isEmpty() && !name.startsWith(QLatin1Char('.'))
+            && !name.contains(QLatin1Char('/')) && !name.contains(QLatin1Char('\\'));
+}
+
+} // namespace
+
+QJsonBlobStore::QJsonBlobStore(const QString &directory, int threshold)
+  : directory_(directory)
+  , threshold_(threshold)
+{
+}
+
+/**
+* This method writes @p bytes to "<directory>/<sha1>.bin", unless that file
+* already holds them, and returns the reference stored in the document.
+*
+* @param bytes The property value.
+*/
+QJsonObject QJsonBlobStore::store(const QByteArray &bytes)
+{
+    const QString name = QString::fromLatin1(
+                QCryptographicHash::hash(bytes, QCryptographicHash::Sha1).toHex()) + QLatin1String(".bin");
+    const QString path = directory_ + QLatin1Char('/') + name;
+
+    if (!used_.contains(name) && QFileInfo(path).size() != bytes.size()) {
+        if (!QDir().mkpath(directory_)) {
+            qCWarning(lcQJsonHelper) << "Blob directory[" << directory_ << "]create error";
+            return QJsonObject();
+        }
+        QSaveFile f(path);
+        if (!f.open(QIODevice::WriteOnly) || f.write(bytes) != bytes.size() || !f.commit()) {
+            qCWarning(lcQJsonHelper) << "File[" << path << "]write error: " << f.errorString();
+            return QJsonObject();
+        }
+    }
+    used_.insert(name);
+
+    QJsonObject reference;
+    reference.insert(BlobKey, name);
+    reference.insert(SizeKey, double(bytes.size()));
+    return reference;
+}
+
+/**
+* This method reads the blob @p reference points to.
+*
+* @param reference A reference produced by store().
+* @param bytes Receives the blob.
+*/
+bool QJsonBlobStore::resolve(const QJsonObject &reference, QByteArray *bytes) const
+{
+    const QString name = reference.value(BlobKey).toString();
+    if (!isBlobName(name)) {
+        qCWarning(lcQJsonHelper) << "Invalid blob reference" << name;
+        return false;
+    }
+    QFile f(directory_ + QLatin1Char('/') + name);
+    if (!f.open(QIODevice::ReadOnly)) {
+        qCWarning(lcQJsonHelper) << "File[" << f.fileName() << "]open error: " << f.errorString();
+        return false;
+    }
+    *bytes = f.readAll();
+    const QJsonValue size = reference.value(SizeKey);
+    if (size.isDouble() && qint64(size.toDouble()) != bytes->size()) {
+        qCWarning(lcQJsonHelper) << "Blob[" << f.fileName() << "]size mismatch";
+        return false;
+    }
+    return true;
+}
+
+void QJsonBlobStore::removeUnused()
+{
+    QDir dir(directory_);
+    const QStringList files = dir.entryList(QStringList(QStringLiteral("*.bin")), QDir::Files);
+    for (const QString &file : files) {
+        if (!used_.contains(file))
+            dir.remove(file);
+    }
+}
+
+bool QJsonBlobStore::isReference(const QJsonValue &value)
+{
+    return value.isObject() && value.toObject().value(BlobKey).isString();
+}
+
+QString QJsonBlobStore::directoryFor(const QString &fpath)
+{
+    return fpath + QLatin1String(".blobs");
+}
+
+QJsonBlobStore *QJsonBlobStore::current()
+{
+    return currentStore;
+}
+
+QJsonBlobStore::Scope::Scope(QJsonBlobStore *store)
+  : previous_(currentStore)
+{
+    currentStore = store;
+}
+
+QJsonBlobStore::Scope::~Scope()
+{
+    currentStore = previous_;
+}
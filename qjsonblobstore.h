@@ -0,0 +1,71 @@
+﻿#ifndef QJSONBLOBSTORE_H
+#define QJSONBLOBSTORE_H
+
+#include <QtCore/QByteArray>
+#include <QtCore/QJsonObject>
+#include <QtCore/QSet>
+#include <QtCore/QString>
+
+/**
+* @brief Keeps large QByteArray property values in files next to the json
+* document ("sidecar" blobs) instead of Base64 encoding them inline.
+*
+* While a Scope is active on a thread, the json and QVariantMap sinks
+* replace byte arrays of at least threshold() bytes with a reference
+*
+* \code
+*   { "$blob": "<sha1>.bin", "size": 1048576 }
+* \endcode
+*
+* and the QByteArray converter resolves such references when loading.
+* Files are content addressed: an unchanged blob is not rewritten, and
+* equal blobs are stored once. QJsonHelper::setBlobThreshold() turns this
+* on for save() / load().
+*/
+class QJsonBlobStore {
+public:
+    explicit QJsonBlobStore(const QString &directory, int threshold = 64 * 1024);
+
+    QString directory() const {
+        return directory_;
+    }
+
+    int threshold() const {
+        return threshold_;
+    }
+
+    // Writes @p bytes unless an identical blob is already stored and
+    // returns the reference to put in the document (null on error).
+    QJsonObject store(const QByteArray &bytes);
+
+    bool resolve(const QJsonObject &reference, QByteArray *bytes) const;
+
+    // Deletes the blob files not referenced since this store was created.
+    // Call it once the document referencing the blobs has been committed.
+    void removeUnused();
+
+    static bool isReference(const QJsonValue &value);
+
+    // "<fpath>.blobs"
+    static QString directoryFor(const QString &fpath);
+
+    // Store used by the sinks and converters of the calling thread, or nullptr.
+    static QJsonBlobStore *current();
+
+    class Scope {
+    public:
+        explicit Scope(QJsonBlobStore *store);
+        ~Scope();
+
+    private:
+        Q_DISABLE_COPY(Scope)
+        QJsonBlobStore *previous_;
+    };
+
+private:
+    QString directory_;
+    int threshold_;
+    QSet<QString> used_;
+};
+
+#endif // QJSONBLOBSTORE_H
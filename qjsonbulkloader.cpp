@@ -0,0 +1,303 @@
+﻿#include "qjsonbulkloader.h"
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QDir>
+#include <QtCore/QMutex>
+#include <QtCore/QPair>
+#include <QtCore/QPointer>
+#include <QtCore/QQueue>
+#include <QtCore/QRunnable>
+#include <QtCore/QThread>
+#include <QtCore/QThreadPool>
+#include <QtCore/QVector>
+
+#include "qjsonblobstore.h"
+#include "qjsonhelper.h"
+#include "qobjecthelper_p.h"
+
+namespace {
+const int DefaultBatchSize = 64;
+}
+
+// Shared by a load and its parse tasks; outlives the loader if it is
+// destroyed while files are still being parsed.
+struct QJsonBulkLoaderState {
+    QAtomicInt canceled;
+    QMutex mutex;
+    QJsonBulkLoader *loader = nullptr;  // nullptr once canceled
+    QQueue<QPair<QString, QParsedDocument> > ready;
+    bool applyPosted = false;           // an applyBatch() call is queued
+};
+
+namespace {
+
+class ParseTask : public QRunnable
+{
+public:
+    ParseTask(const QSharedPointer<QJsonBulkLoaderState> &state, const QString &fpath)
+      : state_(state), fpath_(fpath) {}
+
+    void run() override {
+        if (state_->canceled.loadAcquire())
+            return;
+        const QParsedDocument doc = qParseDocument(fpath_);
+
+        QMutexLocker locker(&state_->mutex);
+        if (!state_->loader)
+            return;
+        state_->ready.enqueue(qMakePair(fpath_, doc));
+        if (!state_->applyPosted) {
+            state_->applyPosted = true;
+            QMetaObject::invokeMethod(state_->loader, "applyBatch", Qt::QueuedConnection);
+        }
+    }
+
+private:
+    QSharedPointer<QJsonBulkLoaderState> state_;
+    QString fpath_;
+};
+
+} // namespace
+
+QJsonBulkLoader::QJsonBulkLoader(QObject *parent)
+  : QObject(parent)
+  , pool_(QThreadPool::globalInstance())
+  , batchSize_(DefaultBatchSize)
+  , total_(0)
+  , loaded_(0)
+  , failed_(0)
+  , inFlight_(0)
+{
+}
+
+QJsonBulkLoader::~QJsonBulkLoader()
+{
+    cancel();
+}
+
+void QJsonBulkLoader::setFactory(const Factory &factory)
+{
+    factory_ = factory;
+}
+
+void QJsonBulkLoader::setThreadPool(QThreadPool *pool)
+{
+    pool_ = pool ? pool : QThreadPool::globalInstance();
+}
+
+void QJsonBulkLoader::setBatchSize(int size)
+{
+    batchSize_ = qMax(1, size);
+}
+
+int QJsonBulkLoader::maxInFlight() const
+{
+    return qMax(2 * batchSize_, pool_->maxThreadCount());
+}
+
+/**
+* This method starts reading and parsing @p paths on the thread pool, up
+* to maxInFlight() files at a time. The results are applied on this
+* object's thread by applyBatch().
+*
+* @param paths Files to load, JSON or CBOR.
+* @return false if a load is running or no factory is set.
+*/
+bool QJsonBulkLoader::load(const QStringList &paths)
+{
+    if (isRunning() || !factory_)
+        return false;
+
+    total_ = paths.size();
+    loaded_ = 0;
+    failed_ = 0;
+    if (paths.isEmpty()) {
+        emit progress(0, 0);
+        emit finished(0, 0);
+        return true;
+    }
+
+    state_ = QSharedPointer<QJsonBulkLoaderState>::create();
+    state_->loader = this;
+    pending_ = paths;
+    inFlight_ = 0;
+    startParsing();
+    return true;
+}
+
+// Hands pending files to the thread pool while fewer than maxInFlight()
+// are parsed or waiting to be applied.
+void QJsonBulkLoader::startParsing()
+{
+    const int limit = maxInFlight();
+    while (inFlight_ < limit && !pending_.isEmpty()) {
+        ++inFlight_;
+        pool_->start(new ParseTask(state_, pending_.takeFirst()));
+    }
+}
+
+bool QJsonBulkLoader::loadDirectory(const QString &dir, const QStringList &nameFilters)
+{
+    const QDir directory(dir);
+    QStringList paths;
+    const QStringList names = directory.entryList(nameFilters, QDir::Files | QDir::Readable, QDir::Name);
+    paths.reserve(names.size());
+    for (const QString &name : names)
+        paths.append(directory.filePath(name));
+    return load(paths);
+}
+
+void QJsonBulkLoader::cancel()
+{
+    if (!state_)
+        return;
+    state_->canceled.storeRelease(1);
+    {
+        QMutexLocker locker(&state_->mutex);
+        state_->loader = nullptr;
+    }
+    state_.reset();
+    pending_.clear();
+    inFlight_ = 0;
+}
+
+/**
+* QJsonHelper::load(fpath, object) for a document that is already parsed.
+* Runs in the thread @p object lives in.
+*/
+void QJsonBulkLoader::applyToObject(const QString &fpath, const QParsedDocument &doc, QObject *object)
+{
+    if (QJsonHelper *helper = qobject_cast<QJsonHelper *>(object)) {
+        helper->applyDocument(fpath, doc);
+        return;
+    }
+    QJsonBlobStore blobs(QJsonBlobStore::directoryFor(fpath));
+    QJsonBlobStore::Scope scope(&blobs);
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+    if (doc.cbor)
+        QObjectHelper::qcbormap2qobject(doc.cborMap, object);
+    else
+#endif
+        QObjectHelper::qjsonobject2qobject(doc.json, object);
+}
+
+/**
+* This method posts @p doc to the event loop of the thread @p object lives
+* in, applies it there and reports the result back to this object's thread
+* through objectApplied(). A relay object moved to that thread carries the
+* call, so the call still arrives (and reports a failure) if @p object is
+* destroyed first.
+*/
+void QJsonBulkLoader::applyInObjectThread(const QString &fpath, const QParsedDocument &doc, QObject *object)
+{
+    const QWeakPointer<QJsonBulkLoaderState> weakState = state_;
+    const QPointer<QObject> target(object);
+    QObject *relay = new QObject;
+    relay->moveToThread(object->thread());
+    QMetaObject::invokeMethod(relay, [relay, weakState, target, object, fpath, doc]() {
+        relay->deleteLater();
+        const bool ok = !target.isNull();
+        if (ok)
+            applyToObject(fpath, doc, target.data());
+
+        const QSharedPointer<QJsonBulkLoaderState> state = weakState.toStrongRef();
+        if (!state)
+            return;
+        QMutexLocker locker(&state->mutex);
+        QJsonBulkLoader *loader = state->loader;
+        if (!loader)
+            return;     // canceled
+        QMetaObject::invokeMethod(loader, [loader, state, fpath, object, ok]() {
+            if (loader->state_ == state)
+                loader->objectApplied(fpath, object, ok);
+        }, Qt::QueuedConnection);
+    }, Qt::QueuedConnection);
+}
+
+// Result of applyInObjectThread(), on this object's thread.
+void QJsonBulkLoader::objectApplied(const QString &fpath, QObject *object, bool ok)
+{
+    const QSharedPointer<QJsonBulkLoaderState> state = state_;
+    --inFlight_;
+    if (ok) {
+        ++loaded_;
+        emit loaded(fpath, object);
+    } else {
+        ++failed_;
+        emit failed(fpath, QStringLiteral("target object destroyed before it was loaded"));
+    }
+    if (state_ == state)
+        reportProgress();
+}
+
+void QJsonBulkLoader::reportProgress()
+{
+    startParsing();
+    emit progress(done(), total_);
+    if (done() == total_) {
+        state_.reset();
+        emit finished(loaded_, failed_);
+    }
+}
+
+/**
+* This method applies up to batchSize() parsed files, then yields to the
+* event loop if more are waiting.
+*/
+void QJsonBulkLoader::applyBatch()
+{
+    // kept alive even if a slot connected to loaded() calls cancel()
+    const QSharedPointer<QJsonBulkLoaderState> state = state_;
+    if (!state)
+        return;
+
+    QVector<QPair<QString, QParsedDocument> > batch;
+    bool more;
+    {
+        QMutexLocker locker(&state->mutex);
+        const int n = qMin(batchSize_, state->ready.size());
+        batch.reserve(n);
+        for (int i = 0; i < n; ++i)
+            batch.append(state->ready.dequeue());
+        more = !state->ready.isEmpty();
+        state->applyPosted = more;
+    }
+    if (more)
+        QMetaObject::invokeMethod(this, "applyBatch", Qt::QueuedConnection);
+    if (batch.isEmpty())
+        return;
+
+    for (const QPair<QString, QParsedDocument> &item : batch) {
+        if (state_ != state)
+            return;
+        const QString &fpath = item.first;
+        const QParsedDocument &doc = item.second;
+        if (!doc.ok) {
+            --inFlight_;
+            ++failed_;
+            emit failed(fpath, doc.error);
+            continue;
+        }
+
+        QObject *object = factory_(fpath);
+        if (!object) {
+            --inFlight_;
+            ++failed_;
+            emit failed(fpath, QStringLiteral("no target object"));
+            continue;
+        }
+        // properties are written in the thread the object lives in
+        if (object->thread() != thread()) {
+            applyInObjectThread(fpath, doc, object);
+            continue;
+        }
+        applyToObject(fpath, doc, object);
+        --inFlight_;
+        ++loaded_;
+        emit loaded(fpath, object);
+    }
+
+    if (state_ != state)
+        return;
+    reportProgress();
+}
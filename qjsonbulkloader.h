@@ -0,0 +1,125 @@
+﻿#ifndef QJSONBULKLOADER_H
+#define QJSONBULKLOADER_H
+
+#include <QtCore/QObject>
+#include <QtCore/QSharedPointer>
+#include <QtCore/QStringList>
+
+#include <functional>
+
+QT_BEGIN_NAMESPACE
+class QThreadPool;
+QT_END_NAMESPACE
+
+struct QJsonBulkLoaderState;
+struct QParsedDocument;
+
+/**
+* @brief Loads many model files at once.
+*
+* The files are read and parsed concurrently on a QThreadPool (the global
+* one by default). The parsed documents are handed back to the loader's
+* thread, where the factory creates the target object of each file and its
+* properties are assigned, at most batchSize() files per event loop pass.
+* Files are applied in the order their parsing finishes. A target object
+* living in another thread is written in that thread: the document is
+* posted to its event loop and loaded() follows once it has been applied.
+* At most maxInFlight() files are being parsed or waiting to be applied at
+* a time; the next ones are only read as earlier ones are applied, so a
+* slow consumer does not pile up parsed documents.
+*
+* \code
+*   QJsonBulkLoader *loader = new QJsonBulkLoader(this);
+*   loader->setFactory([this](const QString &) { return new Model(this); });
+*   connect(loader, &QJsonBulkLoader::loaded, this, &Store::addModel);
+*   connect(loader, &QJsonBulkLoader::failed, this, &Store::reportError);
+*   loader->loadDirectory(dataPath);
+* \endcode
+*/
+class QJsonBulkLoader : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Returns the object @p fpath is loaded into, created or found on the
+    // loader's thread; for nullptr the file is reported through failed().
+    typedef std::function<QObject *(const QString &fpath)> Factory;
+
+    explicit QJsonBulkLoader(QObject *parent = nullptr);
+    ~QJsonBulkLoader();
+
+    void setFactory(const Factory &factory);
+
+    // nullptr selects QThreadPool::globalInstance().
+    void setThreadPool(QThreadPool *pool);
+
+    QThreadPool *threadPool() const {
+        return pool_;
+    }
+
+    // Files applied per event loop pass; smaller batches keep the
+    // event loop more responsive while loading.
+    void setBatchSize(int size);
+
+    int batchSize() const {
+        return batchSize_;
+    }
+
+    // Files parsed or applied at the same time: the larger of twice the
+    // batch size and the thread pool's maximum thread count.
+    int maxInFlight() const;
+
+    // Starts loading @p paths; returns false if a load is still running or
+    // no factory is set. Emits finished() when every file has been handled.
+    bool load(const QStringList &paths);
+
+    // load() of the files in @p dir matching @p nameFilters, sorted by name.
+    bool loadDirectory(const QString &dir,
+                       const QStringList &nameFilters = QStringList(QStringLiteral("*.json")));
+
+    // Files that have not been parsed yet are dropped and finished() is not
+    // emitted.
+    void cancel();
+
+    bool isRunning() const {
+        return state_ != nullptr;
+    }
+
+    int total() const {
+        return total_;
+    }
+
+    int done() const {
+        return loaded_ + failed_;
+    }
+
+signals:
+    void loaded(const QString &fpath, QObject *object);
+    void failed(const QString &fpath, const QString &error);
+    void progress(int done, int total);
+    void finished(int loaded, int failed);
+
+private slots:
+    void applyBatch();
+
+private:
+    Q_DISABLE_COPY(QJsonBulkLoader)
+
+    static void applyToObject(const QString &fpath, const QParsedDocument &doc, QObject *object);
+    void applyInObjectThread(const QString &fpath, const QParsedDocument &doc, QObject *object);
+    void objectApplied(const QString &fpath, QObject *object, bool ok);
+    void startParsing();
+    void reportProgress();
+
+    Factory factory_;
+    QThreadPool *pool_;
+    int batchSize_;
+    int total_;
+    int loaded_;
+    int failed_;
+    QStringList pending_;   // files not handed to the thread pool yet
+    int inFlight_;          // files parsed or applied, not reported yet
+    QSharedPointer<QJsonBulkLoaderState> state_;
+};
+
+#endif // QJSONBULKLOADER_H
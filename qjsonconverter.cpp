@@ -0,0 +1,199 @@
+﻿#include "qjsonconverter.h"
+
+#include <QtCore/QByteArray>
+#include <QtCore/QDateTime>
+#include <QtCore/QHash>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonObject>
+#include <QtCore/QReadWriteLock>
+#include <QtCore/QStringList>
+#include <QtCore/QUrl>
+#include <QtCore/QUuid>
+
+#include "qjsonbase64.h"
+#include "qjsonblobstore.h"
+#include "qjsonstats.h"
+
+namespace {
+
+// Slots and converters live until the program exits (see QJsonConverterSlot).
+QJsonConverterSlot *makeSlot(const QJsonConverter &converter)
+{
+    return new QJsonConverterSlot(new QJsonConverter(converter));
+}
+
+template <int TypeId>
+bool numberFromJson(const QJsonValue &json, QVariant &value)
+{
+    if (!json.isDouble())
+        return false;
+    value = QVariant(json.toDouble());
+    return value.convert(TypeId);
+}
+
+template <int TypeId>
+bool dateTimeFromJson(const QJsonValue &json, QVariant &value)
+{
+    if (!json.isString())
+        return false;
+    value = QVariant(json.toString());
+    return value.convert(TypeId) && value.isValid() && !value.isNull();
+}
+
+struct ConverterTable {
+    ConverterTable();
+
+    QReadWriteLock lock;
+    QHash<int, QJsonConverterSlot *> converters;
+};
+
+ConverterTable::ConverterTable()
+{
+    QJsonConverter c;
+
+    c.fromJson = [](const QJsonValue &json, QVariant &value) {
+        value = json.toObject();
+        return true;
+    };
+    converters.insert(QMetaType::QJsonObject, makeSlot(c));
+
+    c.fromJson = [](const QJsonValue &json, QVariant &value) {
+        value = json.toArray();
+        return true;
+    };
+    converters.insert(QMetaType::QJsonArray, makeSlot(c));
+
+    c.fromJson = [](const QJsonValue &json, QVariant &value) {
+        value = QVariant::fromValue(json);
+        return true;
+    };
+    converters.insert(QMetaType::QJsonValue, makeSlot(c));
+
+    // QVariant properties keep the json value as is
+    c.fromJson = [](const QJsonValue &json, QVariant &value) {
+        value = QVariant(json);
+        return true;
+    };
+    converters.insert(QMetaType::QVariant, makeSlot(c));
+
+    // Base64 字符串，或 QJsonBlobStore 的外部文件引用
+    c.fromJson = [](const QJsonValue &json, QVariant &value) {
+        if (QJsonBlobStore::isReference(json)) {
+            QByteArray raw;
+            QJsonBlobStore *store = QJsonBlobStore::current();
+            if (!store) {
+                qCWarning(lcQJsonHelper) << "Blob reference without a QJsonBlobStore";
+                return false;
+            }
+            if (!store->resolve(json.toObject(), &raw))
+                return false;
+            value = raw;
+            return true;
+        }
+        value = QJsonBase64::fromText(json.toString());
+        return true;
+    };
+    converters.insert(QMetaType::QByteArray, makeSlot(c));
+
+    c.fromJson = [](const QJsonValue &json, QVariant &value) {
+        if (!json.isArray())
+            return false;
+        const QJsonArray array = json.toArray();
+        QStringList list;
+        list.reserve(array.size());
+        for (const QJsonValue &v : array)
+            list.append(v.toString());
+        value = list;
+        return true;
+    };
+    converters.insert(QMetaType::QStringList, makeSlot(c));
+
+    c.fromJson = [](const QJsonValue &json, QVariant &value) {
+        if (!json.isString())
+            return false;
+        value = json.toString();
+        return true;
+    };
+    converters.insert(QMetaType::QString, makeSlot(c));
+
+    c.fromJson = [](const QJsonValue &json, QVariant &value) {
+        if (!json.isBool())
+            return false;
+        value = json.toBool();
+        return true;
+    };
+    converters.insert(QMetaType::Bool, makeSlot(c));
+
+    c.fromJson = numberFromJson<QMetaType::Int>;
+    converters.insert(QMetaType::Int, makeSlot(c));
+    c.fromJson = numberFromJson<QMetaType::UInt>;
+    converters.insert(QMetaType::UInt, makeSlot(c));
+    c.fromJson = numberFromJson<QMetaType::LongLong>;
+    converters.insert(QMetaType::LongLong, makeSlot(c));
+    c.fromJson = numberFromJson<QMetaType::ULongLong>;
+    converters.insert(QMetaType::ULongLong, makeSlot(c));
+    c.fromJson = numberFromJson<QMetaType::Double>;
+    converters.insert(QMetaType::Double, makeSlot(c));
+    c.fromJson = numberFromJson<QMetaType::Float>;
+    converters.insert(QMetaType::Float, makeSlot(c));
+
+    c.fromJson = dateTimeFromJson<QMetaType::QDateTime>;
+    converters.insert(QMetaType::QDateTime, makeSlot(c));
+    c.fromJson = dateTimeFromJson<QMetaType::QDate>;
+    converters.insert(QMetaType::QDate, makeSlot(c));
+    c.fromJson = dateTimeFromJson<QMetaType::QTime>;
+    converters.insert(QMetaType::QTime, makeSlot(c));
+
+    c.fromJson = [](const QJsonValue &json, QVariant &value) {
+        if (!json.isString())
+            return false;
+        value = QUrl(json.toString());
+        return true;
+    };
+    converters.insert(QMetaType::QUrl, makeSlot(c));
+
+    c.fromJson = [](const QJsonValue &json, QVariant &value) {
+        if (!json.isString())
+            return false;
+        const QUuid uuid(json.toString());
+        value = QVariant::fromValue(uuid);
+        return !uuid.isNull();
+    };
+    converters.insert(QMetaType::QUuid, makeSlot(c));
+}
+
+} // namespace
+
+Q_GLOBAL_STATIC(ConverterTable, converterTable)
+
+/**
+* Installs @p converter for @p typeId, replacing the built-in one if any.
+* The previous converter is retired, not freed: threads converting objects
+* right now may still be running it.
+*/
+void QJsonConverterRegistry::registerConverter(int typeId, const QJsonConverter &converter)
+{
+    ConverterTable *table = converterTable();
+    QWriteLocker locker(&table->lock);
+    QJsonConverterSlot *&slot = table->converters[typeId];
+    if (slot)
+        slot->current_.storeRelease(new QJsonConverter(converter));
+    else
+        slot = makeSlot(converter);
+}
+
+const QJsonConverterSlot *QJsonConverterRegistry::slot(int typeId)
+{
+    ConverterTable *table = converterTable();
+    {
+        QReadLocker locker(&table->lock);
+        QJsonConverterSlot *slot = table->converters.value(typeId);
+        if (slot)
+            return slot;
+    }
+    QWriteLocker locker(&table->lock);
+    QJsonConverterSlot *&slot = table->converters[typeId];
+    if (!slot)
+        slot = makeSlot(QJsonConverter());
+    return slot;
+}
@@ -0,0 +1,96 @@
+﻿#ifndef QJSONCONVERTER_H
+#define QJSONCONVERTER_H
+
+#include <QtCore/QAtomicPointer>
+#include <QtCore/QJsonValue>
+#include <QtCore/QMetaType>
+#include <QtCore/QVariant>
+
+#include <functional>
+
+/**
+* @brief JSON conversion of one metatype.
+*
+* fromJson() returns false when @p json does not have a shape it handles;
+* QObjectHelper then falls back to QVariant::convert(). An empty toJson
+* keeps the default serialization of the type.
+*/
+struct QJsonConverter {
+    std::function<QJsonValue(const QVariant &value)> toJson;
+    std::function<bool(const QJsonValue &json, QVariant &value)> fromJson;
+};
+
+/**
+* @brief The current converter of one metatype.
+*
+* Converters are immutable once published. Registering a converter swaps
+* in a new one; the replaced converter is retired but never freed, since
+* a lock-free reader on another thread may still be running it.
+*/
+class QJsonConverterSlot {
+public:
+    explicit QJsonConverterSlot(const QJsonConverter *converter) : current_(converter) {}
+
+    const QJsonConverter *get() const { return current_.loadAcquire(); }
+
+private:
+    friend class QJsonConverterRegistry;
+    Q_DISABLE_COPY(QJsonConverterSlot)
+
+    QAtomicPointer<const QJsonConverter> current_;
+};
+
+/**
+* @brief Converters keyed by metatype id.
+*
+* Property plans resolve the converter slot of each property once, so
+* dispatch is an atomic load per property. Built-in converters cover
+* the JSON container types, QByteArray (Base64), QStringList, QString,
+* bool, the numeric types, QVariant, QDateTime / QDate / QTime (ISO 8601),
+* QUrl and QUuid.
+*
+* Converters can be registered at any time, also while other threads
+* convert objects; those pick up the new converter on their next property.
+* Registering at startup keeps the results consistent:
+*
+* \code
+*   QJsonConverterRegistry::registerType<QColor>(
+*       [](const QColor &c) { return QJsonValue(c.name(QColor::HexArgb)); },
+*       [](const QJsonValue &json, QColor &c) {
+*           c = QColor(json.toString());
+*           return c.isValid();
+*       });
+* \endcode
+*/
+class QJsonConverterRegistry {
+public:
+    static void registerConverter(int typeId, const QJsonConverter &converter);
+
+    template <typename T>
+    static void registerType(std::function<QJsonValue(const T &)> toJson,
+                             std::function<bool(const QJsonValue &, T &)> fromJson) {
+        QJsonConverter converter;
+        if (toJson) {
+            converter.toJson = [toJson](const QVariant &value) {
+                return toJson(value.value<T>());
+            };
+        }
+        if (fromJson) {
+            converter.fromJson = [fromJson](const QJsonValue &json, QVariant &value) {
+                T t{};
+                if (!fromJson(json, t))
+                    return false;
+                value = QVariant::fromValue(t);
+                return true;
+            };
+        }
+        registerConverter(qMetaTypeId<T>(), converter);
+    }
+
+    // The converter slot of @p typeId. Slots are created on demand and
+    // never move, so a converter registered later is still picked up by
+    // plans that resolved the slot earlier.
+    static const QJsonConverterSlot *slot(int typeId);
+};
+
+#endif // QJSONCONVERTER_H
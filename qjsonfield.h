@@ -0,0 +1,315 @@
+﻿#ifndef QJSONFIELD_H
+#define QJSONFIELD_H
+
+#include <QtCore/QByteArray>
+#include <QtCore/QDebug>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonObject>
+#include <QtCore/QJsonValue>
+#include <QtCore/QStringList>
+#include <QtCore/QVariant>
+#include <QtCore/QVector>
+
+#include <cstring>
+#include <type_traits>
+
+#include "qjsonbase64.h"
+#include "qjsonstats.h"
+
+QT_BEGIN_NAMESPACE
+class QObject;
+QT_END_NAMESPACE
+
+/**
+* @brief Typed conversion between a property value and its JSON form.
+*
+* fromJson() returns false when @p json does not have the expected shape;
+* the caller then falls back to the generic QMetaProperty conversion, so
+* specializations only need to handle the common, unambiguous cases.
+* The primary template goes through QVariant and is used for every type
+* without a specialization. Properties of such types are not bound as
+* typed fields (see QJsonFieldDescriptor), so a converter registered for
+* the type applies to reads and writes alike.
+*/
+template <typename T>
+struct QJsonFieldTraits {
+    typedef void Generic;
+
+    static QJsonValue toJson(const T &value) {
+        return QJsonValue::fromVariant(QVariant::fromValue(value));
+    }
+    static bool fromJson(const QJsonValue &, T &) {
+        return false;
+    }
+};
+
+template <>
+struct QJsonFieldTraits<bool> {
+    static QJsonValue toJson(bool value) { return QJsonValue(value); }
+    static bool fromJson(const QJsonValue &json, bool &value) {
+        if (!json.isBool())
+            return false;
+        value = json.toBool();
+        return true;
+    }
+};
+
+template <>
+struct QJsonFieldTraits<int> {
+    static QJsonValue toJson(int value) { return QJsonValue(value); }
+    static bool fromJson(const QJsonValue &json, int &value) {
+        if (!json.isDouble())
+            return false;
+        value = qRound(json.toDouble());   // same rounding as QVariant::convert()
+        return true;
+    }
+};
+
+template <>
+struct QJsonFieldTraits<qint64> {
+    static QJsonValue toJson(qint64 value) { return QJsonValue(value); }
+    static bool fromJson(const QJsonValue &json, qint64 &value) {
+        if (!json.isDouble())
+            return false;
+        value = qRound64(json.toDouble());
+        return true;
+    }
+};
+
+template <>
+struct QJsonFieldTraits<double> {
+    static QJsonValue toJson(double value) { return QJsonValue(value); }
+    static bool fromJson(const QJsonValue &json, double &value) {
+        if (!json.isDouble())
+            return false;
+        value = json.toDouble();
+        return true;
+    }
+};
+
+template <>
+struct QJsonFieldTraits<float> {
+    static QJsonValue toJson(float value) { return QJsonValue(double(value)); }
+    static bool fromJson(const QJsonValue &json, float &value) {
+        if (!json.isDouble())
+            return false;
+        value = float(json.toDouble());
+        return true;
+    }
+};
+
+template <>
+struct QJsonFieldTraits<QString> {
+    static QJsonValue toJson(const QString &value) { return QJsonValue(value); }
+    static bool fromJson(const QJsonValue &json, QString &value) {
+        if (!json.isString())
+            return false;
+        value = json.toString();
+        return true;
+    }
+};
+
+template <>
+struct QJsonFieldTraits<QStringList> {
+    static QJsonValue toJson(const QStringList &value) {
+        return QJsonArray::fromStringList(value);
+    }
+    static bool fromJson(const QJsonValue &json, QStringList &value) {
+        if (!json.isArray())
+            return false;
+        const QJsonArray array = json.toArray();
+        value.clear();
+        value.reserve(array.size());
+        for (const QJsonValue &v : array)
+            value.append(v.toString());
+        return true;
+    }
+};
+
+// QByteArray 以 Base64 字符串存储，与 qjsonobject2qobject 一致
+template <>
+struct QJsonFieldTraits<QByteArray> {
+    static QJsonValue toJson(const QByteArray &value) {
+        return QJsonValue(QJsonBase64::encodeToString(value));
+    }
+    static bool fromJson(const QJsonValue &json, QByteArray &value) {
+        if (!json.isString())
+            return false;
+        value = QJsonBase64::fromText(json.toString());
+        return true;
+    }
+};
+
+template <>
+struct QJsonFieldTraits<QJsonObject> {
+    static QJsonValue toJson(const QJsonObject &value) { return QJsonValue(value); }
+    static bool fromJson(const QJsonValue &json, QJsonObject &value) {
+        value = json.toObject();
+        return true;
+    }
+};
+
+template <>
+struct QJsonFieldTraits<QJsonArray> {
+    static QJsonValue toJson(const QJsonArray &value) { return QJsonValue(value); }
+    static bool fromJson(const QJsonValue &json, QJsonArray &value) {
+        value = json.toArray();
+        return true;
+    }
+};
+
+template <>
+struct QJsonFieldTraits<QJsonValue> {
+    static QJsonValue toJson(const QJsonValue &value) { return value; }
+    static bool fromJson(const QJsonValue &json, QJsonValue &value) {
+        value = json;
+        return true;
+    }
+};
+
+/**
+* @brief One typed field of a class: its JSON key plus direct, QVariant-free
+* accessors that call the generated getter and setter. Both accessors are
+* null for types that only have the primary QJsonFieldTraits template.
+*/
+struct QJsonFieldDescriptor {
+    const char *name;
+    QJsonValue (*read)(const QObject *object);
+    bool (*write)(QObject *object, const QJsonValue &value);
+};
+
+template <int N>
+struct QJsonFieldIndex {
+    enum { value = N };
+};
+
+namespace QJsonFieldDetail {
+
+// True for types without a QJsonFieldTraits specialization.
+template <typename T, typename = void>
+struct IsGeneric : std::false_type {};
+
+template <typename T>
+struct IsGeneric<T, typename QJsonFieldTraits<T>::Generic> : std::true_type {};
+
+// Fields are numbered with __COUNTER__, which other macros in the same
+// translation unit may also consume; tolerate that many holes in a row.
+const int MaxGap = 16;
+
+template <typename Self, int N, int Gap>
+void collect(QVector<QJsonFieldDescriptor> &fields, long);
+
+template <typename Self, int N, int Gap>
+auto collect(QVector<QJsonFieldDescriptor> &fields, int)
+    -> decltype(Self::template qJsonField<Self>(QJsonFieldIndex<N>()), void())
+{
+    fields.append(Self::template qJsonField<Self>(QJsonFieldIndex<N>()));
+    collect<Self, N + 1, 0>(fields, 0);
+}
+
+template <typename Self, int N, int Gap>
+void collectNext(QVector<QJsonFieldDescriptor> &, std::false_type) {}
+
+template <typename Self, int N, int Gap>
+void collectNext(QVector<QJsonFieldDescriptor> &fields, std::true_type)
+{
+    collect<Self, N + 1, Gap + 1>(fields, 0);
+}
+
+template <typename Self, int N, int Gap>
+void collect(QVector<QJsonFieldDescriptor> &fields, long)
+{
+    collectNext<Self, N, Gap>(fields, std::integral_constant<bool, (Gap < MaxGap)>());
+}
+
+} // namespace QJsonFieldDetail
+
+/**
+* @brief Per-class table of typed fields, generated at compile time from the
+* Q_PROPERTY_AUTO / Q_PROPERTY_AUTOINIT / Q_PROPERTY_AUTOGEN_VIRTUAL macros
+* of a class that declares Q_JSON_FIELDS.
+*
+* QObjectHelper binds the table to the class's property plan, so those
+* properties are serialized and deserialized through the typed accessors
+* instead of QMetaProperty and QVariant.
+*/
+class QJsonFieldTable {
+public:
+    // nullptr also for fields without typed accessors
+    const QJsonFieldDescriptor *find(const char *name) const {
+        for (const QJsonFieldDescriptor &field : fields) {
+            if (std::strcmp(field.name, name) == 0)
+                return field.read ? &field : nullptr;
+        }
+        return nullptr;
+    }
+
+    template <typename Self, int Begin>
+    static const QJsonFieldTable *of() {
+        static const QJsonFieldTable table(build<Self, Begin>());
+        return &table;
+    }
+
+    QVector<QJsonFieldDescriptor> fields;
+
+private:
+    explicit QJsonFieldTable(const QVector<QJsonFieldDescriptor> &f) : fields(f) {}
+
+    template <typename Self, int Begin>
+    static QVector<QJsonFieldDescriptor> build() {
+        QVector<QJsonFieldDescriptor> fields;
+        QJsonFieldDetail::collect<Self, Begin + 1, 0>(fields, 0);
+        return fields;
+    }
+};
+
+/**
+ * @brief Q_JSON_FIELD
+ * 由 Q_PROPERTY_AUTO* 宏内部使用：为属性生成类型化的字段描述符。
+ * Used inside the Q_PROPERTY_AUTO* macros: emits the typed field descriptor of a property.
+ */
+#define Q_JSON_FIELD(TYPE, NAME)                                                        \
+    template <typename Self>                                                            \
+    static QJsonFieldDescriptor qJsonField(QJsonFieldIndex<__COUNTER__>) {              \
+        QJsonFieldDescriptor field = {                                                  \
+            #NAME,                                                                      \
+            [](const QObject *object) -> QJsonValue {                                   \
+                return QJsonFieldTraits<TYPE>::toJson(                                  \
+                    static_cast<const Self *>(object)->NAME());                         \
+            },                                                                          \
+            [](QObject *object, const QJsonValue &json) -> bool {                       \
+                TYPE value{};                                                           \
+                if (!QJsonFieldTraits<TYPE>::fromJson(json, value))                     \
+                    return false;                                                       \
+                static_cast<Self *>(object)->set##NAME(value);                          \
+                return true;                                                            \
+            }                                                                           \
+        };                                                                              \
+        if (QJsonFieldDetail::IsGeneric<TYPE>::value) {                                 \
+            field.read = nullptr;                                                       \
+            field.write = nullptr;                                                      \
+        }                                                                               \
+        return field;                                                                   \
+    }
+
+/**
+ * @brief Q_JSON_FIELDS
+ * 为 QJsonHelper 子类开启类型化字段表。放在类声明开头（Q_OBJECT 之后），
+ * 之后声明的 Q_PROPERTY_AUTO / Q_PROPERTY_AUTOINIT / Q_PROPERTY_AUTOGEN_VIRTUAL 属性
+ * 在序列化与反序列化时直接调用 getter/setter，不经过 QVariant。
+ * Enables the typed field table of a QJsonHelper subclass. Place it at the top of the
+ * class (after Q_OBJECT); the Q_PROPERTY_AUTO* properties declared after it are then
+ * converted through their getters/setters directly, bypassing QVariant. Other
+ * properties, and classes without Q_JSON_FIELDS, use the QMetaProperty path.
+ */
+#define Q_JSON_FIELDS                                                                   \
+private:                                                                                \
+    enum { qJsonFieldsBegin = __COUNTER__ };                                            \
+public:                                                                                 \
+    const QJsonFieldTable *jsonFieldTable() const override {                            \
+        typedef std::remove_cv<std::remove_reference<decltype(*this)>::type>::type Self; \
+        return QJsonFieldTable::of<Self, qJsonFieldsBegin>();                           \
+    }                                                                                   \
+private:
+
+#endif // QJSONFIELD_H
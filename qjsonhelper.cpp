@@ -1,87 +1,453 @@
 ﻿#include "qjsonhelper.h"
+#include "qjsonblobstore.h"
+#include "qjsonjournal.h"
+#include "qjsonstats.h"
+#include "qjsonstreamwriter.h"
+#include "qobjecthelper_p.h"
+#include "qobjectsink.h"
+#include <QMetaMethod>
 #include <QMetaProperty>
 #include <QVariant>
 #include <QJsonDocument>
+#include <QSaveFile>
+#include <QTimer>
+#include <QtConcurrent/QtConcurrentRun>
 
+namespace {
+
+// The journal of @p object that records against @p fpath, if any.
+QJsonJournal *journalFor(const QObject *object, const QString &fpath)
+{
+    const QJsonHelper *helper = qobject_cast<const QJsonHelper *>(object);
+    return helper && helper->isJournaling(fpath) ? helper->journal() : nullptr;
+}
+
+// Writes the model file @p fpath through QSaveFile with @p write. If
+// @p object journals into that file, the journal is rebased on the new
+// content; otherwise the records appended later would name the old
+// snapshot and replay() would skip them.
+template <typename Write>
+bool writeModelFile(const QObject *object, const QString &fpath, QIODevice::OpenMode mode, Write write)
+{
+    QJsonJournal *journal = journalFor(object, fpath);
+    const QJsonJournal::Checkpoint checkpoint = journal ? journal->checkpoint() : QJsonJournal::Checkpoint();
+
+    QSaveFile f(fpath);
+    if (!f.open(mode)) {
+        qCWarning(lcQJsonHelper) << "File[" << fpath << "]open error: " << f.errorString();
+        return false;
+    }
+    if (!write(&f)) {
+        f.cancelWriting();
+        return false;
+    }
+    if (!f.commit())
+        return false;
+    return !journal || journal->rebase(checkpoint);
+}
+
+// Writes a traversal recorded on the object's thread as compact json,
+// through the same QJsonWriterSink save() uses. Runs on the thread pool;
+// the journal is rebased by the caller.
+bool writeSnapshot(const QString &fpath, const QObjectRecordSink &snapshot)
+{
+    return writeModelFile(nullptr, fpath, QIODevice::WriteOnly, [&snapshot](QIODevice *device) {
+        QJsonStreamWriter writer(device, QJsonDocument::Compact);
+        QJsonWriterSink sink(writer);
+        snapshot.replay(sink);
+        return writer.flush();
+    });
+}
+
+// Emits @p signal (a NOTIFY signal of @p object) with the property's value
+// as its argument, if it takes one.
+void emitNotifySignal(QObject *object, const QMetaMethod &signal, const QVariant &value)
+{
+    if (signal.parameterCount() == 0) {
+        signal.invoke(object, Qt::DirectConnection);
+        return;
+    }
+    const int type = signal.parameterType(0);
+    QVariant argument = value;
+    if (type == QMetaType::QVariant) {
+        signal.invoke(object, Qt::DirectConnection, Q_ARG(QVariant, argument));
+        return;
+    }
+    if (signal.parameterCount() > 1 || (argument.userType() != type && !argument.convert(type))) {
+        qCWarning(lcQJsonHelper) << "Can't emit" << signal.methodSignature() << "after an update";
+        return;
+    }
+    signal.invoke(object, Qt::DirectConnection,
+                  QGenericArgument(QMetaType::typeName(type), argument.constData()));
+}
+
+} // namespace
+
+QParsedDocument qParseDocument(const QString &fpath)
+{
+    QParsedDocument doc;
+    const bool opened = qReadMappedFile(fpath, [&doc](const QByteArray &content) {
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+        if (QObjectHelper::isCbor(content)) {
+            QCborParserError error;
+            QCborValue value = QCborValue::fromCbor(content, &error);
+            if (error.error != QCborError::NoError) {
+                qCWarning(lcQJsonHelper) << error.errorString();
+                doc.error = error.errorString();
+                return;
+            }
+            if (value.isTag() && value.tag() == QCborKnownTags::Signature)
+                value = value.taggedValue();
+            doc.cbor = true;
+            doc.cborMap = value.toMap();
+            doc.ok = true;
+            return;
+        }
+#endif
+        QJsonParseError error;
+        QJsonDocument json = QJsonDocument::fromJson(content, &error);
+        if (error.error != QJsonParseError::NoError) {
+            qCWarning(lcQJsonHelper) << error.errorString();
+            doc.error = error.errorString();
+            return;
+        }
+        doc.json = json.object();
+        doc.ok = true;
+    });
+    if (!opened)
+        doc.error = QStringLiteral("can't open file");
+    return doc;
+}
 
 QJsonHelper::QJsonHelper(QObject *parent) : QObject(parent)
 {
     loadFinish_ = false;
+    saveDebounce_ = 0;
+    saveRunning_ = false;
+    saveTimer_ = nullptr;
+    journal_ = nullptr;
+    blobThreshold_ = 0;
+    updateDepth_ = 0;
+    updateBlockedSignals_ = false;
+    updateLog_ = nullptr;
+}
+
+QJsonHelper::~QJsonHelper(){
+    delete updateLog_;
 }
 
 bool QJsonHelper::save(const QString& fpath){
-    bool ret = false;
-    QFile f(fpath);
-    if (f.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate	)){
-        f.write(json().toUtf8());
-        ret = true;
-    }else{
-        qDebug() << "File[" << fpath << "]open error: " << f.errorString();
-    }
-    f.close();
-    return ret;
+    QScopedPointer<QJsonBlobStore> blobs(blobThreshold_ > 0
+            ? new QJsonBlobStore(QJsonBlobStore::directoryFor(fpath), blobThreshold_) : nullptr);
+    QJsonBlobStore::Scope scope(blobs ? blobs.data() : QJsonBlobStore::current());
 
+    const bool ok = save(this, fpath);
+    if (ok && blobs)
+        blobs->removeUnused();
+    return ok;
 }
 
 bool QJsonHelper::save(const QObject *object, const QString& fpath, const QStringList &ignoredProperties){
-    bool ret = false;
-    QFile f(fpath);
-    if (f.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate	)){
-        QString json = QObjectHelper::qobject2json(object, ignoredProperties);
-        f.write(json.toUtf8());
-        ret = true;
-    }else{
-        qDebug() << "File[" << fpath << "]open error: " << f.errorString();
+    return writeModelFile(object, fpath, QIODevice::WriteOnly, [&](QIODevice *device) {
+        return QObjectHelper::writeToDevice(device, object, QJsonDocument::Compact, ignoredProperties);
+    });
+}
+
+QFuture<bool> QJsonHelper::saveAsync(const QObject *object, const QString &fpath, const QStringList &ignoredProperties){
+    // Properties must be read on the object's thread; formatting and
+    // writing the recorded values happens on the pool.
+    QJsonJournal *journal = journalFor(object, fpath);
+    const QJsonJournal::Checkpoint checkpoint = journal ? journal->checkpoint() : QJsonJournal::Checkpoint();
+    QObjectRecordSink snapshot;
+    QObjectHelper::visit(object, snapshot, ignoredProperties);
+    const QFuture<bool> future = QtConcurrent::run(writeSnapshot, fpath, snapshot);
+
+    // once the file is committed, rebase the journal on the object's thread
+    if (journal) {
+        QFutureWatcher<bool> *watcher = new QFutureWatcher<bool>(journal);
+        QObject::connect(watcher, &QFutureWatcherBase::finished, journal, [watcher, journal, checkpoint]() {
+            if (watcher->result())
+                journal->rebase(checkpoint);
+            watcher->deleteLater();
+        });
+        watcher->setFuture(future);
     }
-    f.close();
-    return ret;
+    return future;
+}
+
+void QJsonHelper::setSaveDebounce(int msec){
+    saveDebounce_ = qMax(0, msec);
+    if (saveTimer_)
+        saveTimer_->setInterval(saveDebounce_);
+}
+
+void QJsonHelper::saveAsync(const QString& fpath){
+    if (!saveTimer_) {
+        saveTimer_ = new QTimer(this);
+        saveTimer_->setSingleShot(true);
+        saveTimer_->setInterval(saveDebounce_);
+        connect(saveTimer_, &QTimer::timeout, this, &QJsonHelper::startPendingSave);
+    }
+    // one entry per file: repeated requests for the same path coalesce,
+    // requests for other paths queue up behind it
+    if (!pendingSavePaths_.contains(fpath))
+        pendingSavePaths_.append(fpath);
+    saveTimer_->start();
+}
+
+void QJsonHelper::startPendingSave(){
+    // One write at a time; requests arriving meanwhile stay queued and are
+    // drained when the running write finishes.
+    if (saveRunning_ || pendingSavePaths_.isEmpty())
+        return;
+
+    const QString fpath = pendingSavePaths_.takeFirst();
+    saveRunning_ = true;
+
+    // blobs are written while the snapshot is taken, on this thread
+    QSharedPointer<QJsonBlobStore> blobs;
+    if (blobThreshold_ > 0)
+        blobs.reset(new QJsonBlobStore(QJsonBlobStore::directoryFor(fpath), blobThreshold_));
+    QJsonBlobStore::Scope scope(blobs ? blobs.data() : QJsonBlobStore::current());
+
+    QFutureWatcher<bool> *watcher = new QFutureWatcher<bool>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, fpath, blobs]() {
+        const bool ok = watcher->result();
+        watcher->deleteLater();
+        if (ok && blobs)
+            blobs->removeUnused();
+        saveRunning_ = false;
+        emit saveFinished(fpath, ok);
+        if (!pendingSavePaths_.isEmpty() && !saveTimer_->isActive())
+            startPendingSave();
+    });
+    watcher->setFuture(saveAsync(this, fpath));
 }
 
 bool QJsonHelper::load(const QString& fpath, QObject *object){
-    bool ret = false;
-    QFile f(fpath);
-    if (f.open(QIODevice::ReadOnly)){
-        QString content = f.readAll();
+    // only the instance journaling into fpath knows the log is its own
+    QJsonHelper *helper = qobject_cast<QJsonHelper*>(object);
+    if (helper && helper->isJournaling(fpath))
+        return helper->loadFile(fpath, nullptr);
+
+    UpdateGuard guard(helper);
+    QJsonBlobStore blobs(QJsonBlobStore::directoryFor(fpath));
+    QJsonBlobStore::Scope scope(&blobs);
+    bool ret = qReadMappedFile(fpath, [object](const QByteArray &content) {
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+        if (QObjectHelper::isCbor(content)) {
+            QObjectHelper::cbor2qobject(content, object);
+            return;
+        }
+#endif
         QObjectHelper::json2qobject(content, object);
-        ret = true;
-    }else{
-        qDebug() << "File[" << fpath << "]open error: " << f.errorString();
-    }
-    f.close();
+    });
     return ret;
 }
 
 bool QJsonHelper::load(const QString& fpath){
-    bool ret = false;
-    QFile f(fpath);
-    if (f.open(QIODevice::ReadOnly)){
-        QString content = f.readAll();
-        json2qobject(content, this);
+    return loadFile(fpath, nullptr);
+}
+
+bool QJsonHelper::loadProjected(const QString& fpath, const QStringList& properties){
+    return loadFile(fpath, &properties);
+}
+
+bool QJsonHelper::loadProjected(const QString& fpath, QObject *object, const QStringList& properties){
+    QJsonHelper *helper = qobject_cast<QJsonHelper*>(object);
+    if (helper && helper->isJournaling(fpath))
+        return helper->loadFile(fpath, &properties);
+
+    UpdateGuard guard(helper);
+    QJsonBlobStore blobs(QJsonBlobStore::directoryFor(fpath));
+    QJsonBlobStore::Scope scope(&blobs);
+    bool ret = qReadMappedFile(fpath, [object, &properties](const QByteArray &content) {
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+        if (QObjectHelper::isCbor(content)) {
+            QObjectHelper::cbor2qobject(content, object);
+            return;
+        }
+#endif
+        QObjectHelper::json2qobjectProjected(content, object, properties);
+    });
+    return ret;
+}
+
+// load() and loadProjected(); @p properties is null for a full load.
+bool QJsonHelper::loadFile(const QString& fpath, const QStringList *properties){
+    const bool paused = journal_ && journal_->isPaused();
+    if (journal_)
+        journal_->setPaused(true);
+
+    beginUpdate();
+    QJsonBlobStore blobs(QJsonBlobStore::directoryFor(fpath));
+    QJsonBlobStore::Scope scope(&blobs);
+    bool ret = qReadMappedFile(fpath, [this, properties](const QByteArray &content) {
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+        if (QObjectHelper::isCbor(content)) {
+            QObjectHelper::cbor2qobject(content, this);
+            return;
+        }
+#endif
+        if (properties)
+            QObjectHelper::json2qobjectProjected(content, this, *properties);
+        else
+            utf8Json2qobject(content, this);
+    });
+    // changes recorded by our journal since the last snapshot
+    if (isJournaling(fpath) && QJsonJournal::replay(fpath, this) > 0)
         ret = true;
+    endUpdate();    // while the journal is still paused
+
+    if (journal_)
+        journal_->setPaused(paused);
+    if (ret)
         loadFinish_ = true;
-    }else{
-        qDebug() << "File[" << fpath << "]open error: " << f.errorString();
+    checkModel();
+    return ret;
+}
+
+void QJsonHelper::loadAsync(const QString& fpath){
+    QFutureWatcher<QParsedDocument> *watcher = new QFutureWatcher<QParsedDocument>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, fpath]() {
+        const QParsedDocument doc = watcher->result();
+        watcher->deleteLater();
+        const bool ok = applyDocument(fpath, doc);
+        emit loadFinished(fpath, ok);
+    });
+    watcher->setFuture(QtConcurrent::run(qParseDocument, fpath));
+}
+
+// loadAsync() and QJsonBulkLoader: assigns a document parsed by
+// qParseDocument() and replays the journal of @p fpath if it is ours.
+bool QJsonHelper::applyDocument(const QString& fpath, const QParsedDocument& doc){
+    const bool paused = journal_ && journal_->isPaused();
+    if (journal_)
+        journal_->setPaused(true);
+
+    beginUpdate();
+    QJsonBlobStore blobs(QJsonBlobStore::directoryFor(fpath));
+    QJsonBlobStore::Scope scope(&blobs);
+    bool ok = doc.ok;
+    if (doc.ok) {
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+        if (doc.cbor)
+            QObjectHelper::qcbormap2qobject(doc.cborMap, this);
+        else
+#endif
+            QObjectHelper::qjsonobject2qobject(doc.json, this);
     }
-    f.close();
+    if (isJournaling(fpath) && QJsonJournal::replay(fpath, this) > 0)
+        ok = true;
+    endUpdate();
+
+    if (journal_)
+        journal_->setPaused(paused);
+    if (ok)
+        loadFinish_ = true;
+    checkModel();
+    return ok;
+}
+
+bool QJsonHelper::enableJournal(const QString& fpath, qint64 compactThreshold){
+    disableJournal();
+    journal_ = new QJsonJournal(this, fpath, this);
+    journal_->setCompactThreshold(compactThreshold);
+    if (!journal_->open()) {
+        delete journal_;
+        journal_ = nullptr;
+        return false;
+    }
+    return true;
+}
+
+bool QJsonHelper::isJournaling(const QString& fpath) const{
+    return journal_ && journal_->snapshotPath() == fpath;
+}
+
+void QJsonHelper::disableJournal(){
+    delete journal_;
+    journal_ = nullptr;
+}
+
+void QJsonHelper::setBlobThreshold(int bytes){
+    blobThreshold_ = qMax(0, bytes);
+}
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+bool QJsonHelper::saveBinary(const QString& fpath){
+    return saveBinary(this, fpath);
+}
+
+bool QJsonHelper::saveBinary(const QObject *object, const QString& fpath, const QStringList &ignoredProperties){
+    return writeModelFile(object, fpath, QIODevice::WriteOnly, [&](QIODevice *device) {
+        return QObjectHelper::writeCborToDevice(device, object, ignoredProperties);
+    });
+}
+
+bool QJsonHelper::loadBinary(const QString& fpath, QObject *object){
+    UpdateGuard guard(qobject_cast<QJsonHelper*>(object));
+    return qReadMappedFile(fpath, [object](const QByteArray &content) {
+        QObjectHelper::cbor2qobject(content, object);
+    });
+}
+
+bool QJsonHelper::loadBinary(const QString& fpath){
+    beginUpdate();
+    bool ret = loadBinary(fpath, this);
+    endUpdate();
+    if (ret)
+        loadFinish_ = true;
     checkModel();
     return ret;
 }
+#endif
 
 void QJsonHelper::fromVariantMap(const QVariantMap& map)
 {
-    QJsonObject obj = QJsonObject::fromVariantMap(map);
-    QJsonDocument doc(obj);
-    QObjectHelper::json2qobject(
-        QString::fromUtf8(doc.toJson(QJsonDocument::Compact)),
-        this
-        );
+    UpdateGuard guard(this);
+    QObjectHelper::qvariantmap2qobject(map, this);
 }
 
 void QJsonHelper::fromJsonValue(const QJsonValue &jsonVal){
-    QJsonObject jsonObj = jsonVal.toObject();
-    QJsonDocument jsonDoc(jsonObj);
-    QString jsonStrCompact = jsonDoc.toJson(QJsonDocument::Compact);
-    QObjectHelper::json2qobject(jsonStrCompact, this);
+    UpdateGuard guard(this);
+    QObjectHelper::qjsonvalue2qobject(jsonVal, this);
+}
+
+void QJsonHelper::beginUpdate(){
+    if (updateDepth_++ > 0)
+        return;
+    updateBlockedSignals_ = signalsBlocked();
+    if (updateBlockedSignals_)
+        return;     // nobody would hear the notifications anyway
+
+    // the deserializers fill the log with the values before each first write
+    updateLog_ = new QPropertyWriteLog(this);
+    blockSignals(true);
+}
+
+void QJsonHelper::endUpdate(){
+    if (updateDepth_ == 0 || --updateDepth_ > 0)
+        return;
+    if (updateBlockedSignals_)
+        return;
+    blockSignals(false);
+
+    // closed before emitting, so handlers writing properties are not logged
+    QScopedPointer<QPropertyWriteLog> log(updateLog_);
+    updateLog_ = nullptr;
+
+    // properties sharing a NOTIFY signal get it once
+    QSet<int> emitted;
+    typedef QHash<const QPropertyPlanEntry *, QVariant> Values;
+    for (Values::const_iterator it = log->values().constBegin(); it != log->values().constEnd(); ++it) {
+        const QPropertyPlanEntry &entry = *it.key();
+        const QVariant value = entry.meta.read(this);
+        if (value == it.value() || emitted.contains(entry.meta.notifySignalIndex()))
+            continue;
+        emitted.insert(entry.meta.notifySignalIndex());
+        emitNotifySignal(this, entry.meta.notifySignal(), value);
+    }
 }
 
 QDebug operator<<(QDebug dbg, const QObject &obj)
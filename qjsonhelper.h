@@ -5,6 +5,12 @@
 #include <QDebug>
 #include "qobjecthelper.h"
 
+class QJsonBulkLoader;
+class QJsonFieldTable;
+class QJsonJournal;
+class QPropertyWriteLog;
+struct QParsedDocument;
+
 class QJsonHelper : public QObject
 {
     Q_OBJECT
@@ -12,6 +18,9 @@ class QJsonHelper : public QObject
 public:
     explicit QJsonHelper(QObject *parent = nullptr);
 
+    ~QJsonHelper();
+
+    // streamed by QJsonStreamWriter, see QObjectHelper::qobject2json()
     inline QString json() {
         return QObjectHelper::qobject2json(this);
     }
@@ -26,29 +35,167 @@ public:
 
     bool save(const QString& fpath);
 
+    // Non-blocking save(): the properties are read when the write starts and
+    // encoded and written on the thread pool. Calls arriving within
+    // saveDebounce() milliseconds of each other are coalesced into one write.
+    // Emits saveFinished() when done.
+    void saveAsync(const QString& fpath);
+
+    int saveDebounce() const {
+        return saveDebounce_;
+    }
+
+    void setSaveDebounce(int msec);
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+    // CBOR counterparts of save()/load(): QByteArray properties are stored
+    // as raw byte strings and integers stay integers. load() also accepts
+    // files written by saveBinary().
+    bool saveBinary(const QString& fpath);
+
+    bool loadBinary(const QString& fpath);
+#endif
+
+    // Transactions: between the outermost beginUpdate() and endUpdate()
+    // this object's signals are blocked. endUpdate() then emits the NOTIFY
+    // signal of each property QObjectHelper's deserializers wrote whose
+    // value differs from the one before its first write, once, and nothing
+    // for properties that ended up unchanged. Only written properties are
+    // read and compared. load(), loadBinary() (including the static
+    // overloads, which otherwise behave as before: no checkModel() and no
+    // isLoadFinish() update), fromVariantMap(), fromJsonValue() and
+    // Q_PROPERTY_QMLLIST deserialization run inside a transaction.
+    //
+    // Signals are blocked with QObject::blockSignals(), so any other signal
+    // this object emits during a transaction (e.g. from an overridden
+    // checkModel() or json2qobject()) is dropped, not deferred. Properties
+    // such an override sets directly are not renotified either.
+    void beginUpdate();
+
+    void endUpdate();
+
+    bool isUpdating() const {
+        return updateDepth_ > 0;
+    }
+
+    // beginUpdate() / endUpdate() for the lifetime of a scope; does
+    // nothing for a null @p helper.
+    class UpdateGuard {
+    public:
+        explicit UpdateGuard(QJsonHelper *helper) : helper_(helper) {
+            if (helper_)
+                helper_->beginUpdate();
+        }
+        ~UpdateGuard() {
+            if (helper_)
+                helper_->endUpdate();
+        }
+
+    private:
+        Q_DISABLE_COPY(UpdateGuard)
+        QJsonHelper *helper_;
+    };
+
     void fromVariantMap(const QVariantMap& map);
 
     void fromJsonValue(const QJsonValue &jsonVal);
 
     virtual bool load(const QString& fpath);
 
+    // Loads only the listed top level keys (by default this object's
+    // writable properties); the values of other keys are skipped without
+    // being parsed (see QJsonProjection). CBOR files are loaded in full.
+    bool loadProjected(const QString& fpath, const QStringList& properties = QStringList());
+
+    // Non-blocking load(): the file is read and parsed on the thread pool,
+    // the properties are assigned on this object's thread. Emits
+    // loadFinished() when done.
+    void loadAsync(const QString& fpath);
+
+    // Journaling mode: every property change is appended to
+    // "<fpath>.journal" instead of rewriting @p fpath, and load(fpath)
+    // replays the journal over the snapshot. The snapshot is rewritten and
+    // the journal emptied once it grows past @p compactThreshold bytes.
+    // Every save function writing @p fpath (including saveAsync() and
+    // saveBinary()) starts the journal over against the new file.
+    // Enable it before loading: only a load of the file this instance
+    // journals into replays the journal.
+    bool enableJournal(const QString& fpath, qint64 compactThreshold = 1024 * 1024);
 
+    bool isJournaling(const QString& fpath) const;
+
+    void disableJournal();
+
+    QJsonJournal *journal() const {
+        return journal_;
+    }
+
+    // Sidecar blobs: save() and saveAsync() write QByteArray properties of
+    // at least @p bytes bytes to "<fpath>.blobs/" and reference them from
+    // the json instead of Base64 encoding them (see QJsonBlobStore). load()
+    // always resolves such references. 0 (the default) turns this off.
+    void setBlobThreshold(int bytes);
+
+    int blobThreshold() const {
+        return blobThreshold_;
+    }
+
+    // Deprecated: no load path calls this hook any more (load() parses the
+    // UTF-8 bytes through utf8Json2qobject()). Override utf8Json2qobject()
+    // instead; overrides of this one are ignored.
     inline virtual void json2qobject(const QString json, QObject *object){
         QObjectHelper::json2qobject(json, object);
     }
 
+    // Used by load(); @p json may point into a memory mapped file and is
+    // only valid for the duration of the call.
+    inline virtual void utf8Json2qobject(const QByteArray &json, QObject *object){
+        QObjectHelper::json2qobject(json, object);
+    }
+
     inline bool isLoadFinish(){
         return loadFinish_;
     }
 
+    // Typed field table of the class, generated by Q_JSON_FIELDS
+    // (see qjsonfield.h); nullptr for classes without one.
+    virtual const QJsonFieldTable *jsonFieldTable() const {
+        return nullptr;
+    }
+
     static bool save(const QObject *object, const QString &fpath, const QStringList &ignoredProperties = QStringList(QString(QLatin1String("objectName"))));
     static bool load(const QString &fpath, QObject *object);
+    static bool loadProjected(const QString &fpath, QObject *object, const QStringList &properties = QStringList());
+    static QFuture<bool> saveAsync(const QObject *object, const QString &fpath, const QStringList &ignoredProperties = QStringList(QString(QLatin1String("objectName"))));
+
+signals:
+    void saveFinished(const QString &fpath, bool ok);
+    void loadFinished(const QString &fpath, bool ok);
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+    static bool saveBinary(const QObject *object, const QString &fpath, const QStringList &ignoredProperties = QStringList(QString(QLatin1String("objectName"))));
+    static bool loadBinary(const QString &fpath, QObject *object);
+#endif
 protected:
     virtual void checkModel(){}
 
 private:
     friend QDebug operator<<(QDebug dbg, const QObject &obj);
+    friend class QJsonBulkLoader;
+    void startPendingSave();
+    bool loadFile(const QString& fpath, const QStringList *properties);
+    bool applyDocument(const QString& fpath, const QParsedDocument& doc);
+
     bool loadFinish_;
+    int saveDebounce_;
+    bool saveRunning_;
+    QTimer *saveTimer_;
+    QStringList pendingSavePaths_;
+    QJsonJournal *journal_;
+    int blobThreshold_;
+    int updateDepth_;
+    bool updateBlockedSignals_;         // signals were already blocked at beginUpdate()
+    QPropertyWriteLog *updateLog_;      // properties written since beginUpdate()
 };
 
 QDebug operator<<(QDebug dbg, const QObject &obj);
@@ -0,0 +1,563 @@
+﻿#include "qjsonjournal.h"
+
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDebug>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QJsonParseError>
+#include <QtCore/QMetaMethod>
+#include <QtCore/QMetaProperty>
+#include <QtCore/QSaveFile>
+
+#include "qjsonhelper.h"
+#include "qjsonstats.h"
+#include "qjsonstreamwriter.h"
+#include "qobjecthelper.h"
+
+namespace {
+const qint64 DefaultCompactThreshold = 1024 * 1024;
+
+const QString HeaderKey = QStringLiteral("$snapshot");
+const QString PathKey = QStringLiteral("$path");
+const QString SetKey = QStringLiteral("$set");
+const QString ValueKey = QStringLiteral("$value");
+const QString InsertKey = QStringLiteral("$insert");
+const QString ValuesKey = QStringLiteral("$values");
+const QString RemoveKey = QStringLiteral("$remove");
+const QString CountKey = QStringLiteral("$count");
+
+bool isListProperty(const QMetaProperty &property)
+{
+    return property.userType() == QMetaType::QJsonArray;
+}
+
+// The object behind a QObject* property, or behind a Q_PROPERTY_QML
+// property through its NAME##Object() accessor. Never creates one.
+QObject *childObject(QObject *object, const QMetaProperty &property)
+{
+    if (QMetaType::typeFlags(property.userType()) & QMetaType::PointerToQObject)
+        return qvariant_cast<QObject *>(property.read(object));
+    if (property.userType() != QMetaType::QVariantMap)
+        return nullptr;
+
+    const QMetaObject *metaobject = object->metaObject();
+    const int index = metaobject->indexOfMethod((QByteArray(property.name()) + "Object()").constData());
+    if (index < 0)
+        return nullptr;
+    QObject *child = nullptr;
+    metaobject->method(index).invoke(object, Qt::DirectConnection, Q_RETURN_ARG(QObject *, child));
+    return child;
+}
+
+QObject *childObject(QObject *object, const QString &name)
+{
+    const QMetaObject *metaobject = object->metaObject();
+    const int index = metaobject->indexOfProperty(name.toLatin1().constData());
+    return index < 0 ? nullptr : childObject(object, metaobject->property(index));
+}
+
+template <typename Write>
+void appendRecord(QByteArray &records, Write write)
+{
+    {
+        QJsonStreamWriter writer(&records);
+        write(writer);
+    }
+    records.append('\n');
+}
+
+void appendElementRecord(QByteArray &records, const QJsonArray &path,
+                         const QJsonValue &before, const QJsonValue &after)
+{
+    appendRecord(records, [&](QJsonStreamWriter &writer) {
+        writer.beginObject();
+        writer.writeKey(PathKey);
+        writer.writeValue(path);
+        const QJsonObject oldObject = before.toObject();
+        const QJsonObject newObject = after.toObject();
+        if (before.isObject() && after.isObject() && oldObject.keys() == newObject.keys()) {
+            // same members: only the ones that changed
+            writer.writeKey(SetKey);
+            writer.beginObject();
+            for (QJsonObject::const_iterator it = newObject.constBegin(); it != newObject.constEnd(); ++it) {
+                if (oldObject.value(it.key()) != it.value()) {
+                    writer.writeKey(it.key());
+                    writer.writeValue(it.value());
+                }
+            }
+            writer.endObject();
+        } else {
+            writer.writeKey(ValueKey);
+            writer.writeValue(after);
+        }
+        writer.endObject();
+    });
+}
+
+// Applies one record; returns false if its path no longer resolves.
+bool applyRecord(const QJsonObject &record, QObject *object)
+{
+    if (!record.contains(PathKey)) {
+        QObjectHelper::qjsonobject2qobject(record, object);
+        return true;
+    }
+
+    const QJsonArray path = record.value(PathKey).toArray();
+    const int size = path.size();
+    const bool element = size >= 2 && path.at(size - 1).isDouble();
+    const bool list = record.contains(InsertKey) || record.contains(RemoveKey);
+    const int depth = element ? size - 2 : list ? size - 1 : size;
+    if (depth < 0)
+        return false;
+
+    QObject *target = object;
+    for (int i = 0; i < depth && target; ++i)
+        target = childObject(target, path.at(i).toString());
+    if (!target)
+        return false;
+    if (!element && !list) {
+        QObjectHelper::qjsonobject2qobject(record.value(SetKey).toObject(), target);
+        return true;
+    }
+
+    const QString name = path.at(depth).toString();
+    QJsonArray array = target->property(name.toLatin1().constData()).toJsonArray();
+    if (element) {
+        const int index = path.at(size - 1).toInt(-1);
+        if (index < 0 || index >= array.size())
+            return false;
+        if (record.contains(SetKey)) {
+            QJsonObject item = array.at(index).toObject();
+            const QJsonObject changes = record.value(SetKey).toObject();
+            for (QJsonObject::const_iterator it = changes.constBegin(); it != changes.constEnd(); ++it)
+                item.insert(it.key(), it.value());
+            array.replace(index, item);
+        } else {
+            array.replace(index, record.value(ValueKey));
+        }
+    } else if (record.contains(InsertKey)) {
+        int index = record.value(InsertKey).toInt(-1);
+        if (index < 0 || index > array.size())
+            return false;
+        const QJsonArray values = record.value(ValuesKey).toArray();
+        for (const QJsonValue &value : values)
+            array.insert(index++, value);
+    } else {
+        const int index = record.value(RemoveKey).toInt(-1);
+        const int count = record.value(CountKey).toInt(1);
+        if (index < 0 || count < 0 || index + count > array.size())
+            return false;
+        for (int i = 0; i < count; ++i)
+            array.removeAt(index);
+    }
+
+    QJsonObject value;
+    value.insert(name, array);
+    QObjectHelper::qjsonobject2qobject(value, target);
+    return true;
+}
+} // namespace
+
+QJsonJournal::QJsonJournal(QObject *target, const QString &snapshotPath, QObject *parent)
+  : QObject(parent ? parent : target)
+  , target_(target)
+  , snapshotPath_(snapshotPath)
+  , file_(journalPath(snapshotPath))
+  , ignoredProperties_(QStringList(QStringLiteral("objectName")))
+  , compactThreshold_(DefaultCompactThreshold)
+  , epoch_(0)
+  , paused_(false)
+{
+}
+
+QJsonJournal::~QJsonJournal()
+{
+    close();
+}
+
+QString QJsonJournal::journalPath(const QString &snapshotPath)
+{
+    return snapshotPath + QStringLiteral(".journal");
+}
+
+void QJsonJournal::setIgnoredProperties(const QStringList &properties)
+{
+    ignoredProperties_ = properties;
+    if (isOpen())
+        connectNotifySignals();
+}
+
+void QJsonJournal::setPaused(bool paused)
+{
+    const bool resumed = paused_ && !paused;
+    paused_ = paused;
+    // what changed meanwhile (e.g. a load) is not in the log; later list
+    // records have to be computed against the current arrays
+    if (resumed && isOpen())
+        connectNotifySignals();
+}
+
+/**
+* Opens the log for appending and starts recording. An existing log is
+* kept if it was written against the current snapshot file; one that names
+* another snapshot (replay() would skip it) is emptied first, and a new one
+* starts with the id of the current snapshot file. Compaction waits for
+* the next record, so the target can be loaded first.
+*/
+bool QJsonJournal::open()
+{
+    if (!target_)
+        return false;
+    if (isOpen())
+        return true;
+
+    const bool stale = file_.exists() && file_.size() > 0 && !hasCurrentHeader();
+    if (!file_.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        qCWarning(lcQJsonHelper) << "File[" << file_.fileName() << "]open error: " << file_.errorString();
+        return false;
+    }
+    if (stale) {
+        qCDebug(lcQJsonHelper) << "Journal[" << file_.fileName() << "]belongs to an older snapshot, restarted";
+        if (!file_.resize(0)) {
+            file_.close();
+            return false;
+        }
+        ++epoch_;
+    }
+    if (file_.size() == 0 && !writeHeader()) {
+        file_.close();
+        return false;
+    }
+    connectNotifySignals();
+    return true;
+}
+
+void QJsonJournal::close()
+{
+    disconnectNotifySignals();
+    file_.close();
+}
+
+void QJsonJournal::disconnectNotifySignals()
+{
+    for (QHash<QObject *, Node>::const_iterator it = nodes_.constBegin(); it != nodes_.constEnd(); ++it) {
+        if (it->object)
+            disconnect(it->object.data(), nullptr, this, nullptr);
+    }
+    nodes_.clear();
+}
+
+void QJsonJournal::connectNotifySignals()
+{
+    disconnectNotifySignals();
+    if (target_)
+        watch(target_, QJsonArray());
+}
+
+void QJsonJournal::watch(QObject *object, const QJsonArray &path)
+{
+    Node &node = nodes_[object];
+    node.object = object;
+    node.path = path;
+
+    const QMetaMethod slot = staticMetaObject.method(
+                staticMetaObject.indexOfSlot("onPropertyNotify()"));
+    const QMetaObject *metaobject = object->metaObject();
+    QHash<QString, QObject *> children;
+    for (int i = 0; i < metaobject->propertyCount(); ++i) {
+        const QMetaProperty metaproperty = metaobject->property(i);
+        const QString name = QString::fromLatin1(metaproperty.name());
+        if (!metaproperty.isReadable() || !metaproperty.isWritable()
+                || !metaproperty.hasNotifySignal() || ignoredProperties_.contains(name))
+            continue;
+
+        const int signal = metaproperty.notifySignalIndex();
+        if (!node.notifyProperties.contains(signal))
+            connect(object, metaproperty.notifySignal(), this, slot);
+        node.notifyProperties[signal].append(name);
+
+        if (isListProperty(metaproperty)) {
+            node.lists.insert(name, metaproperty.read(object).toJsonArray());
+        } else if (QObject *child = childObject(object, metaproperty)) {
+            if (!nodes_.contains(child))
+                children.insert(name, child);
+        }
+    }
+
+    // node is not used past this point: watch() may rehash nodes_
+    nodes_[object].children = children;
+    for (QHash<QString, QObject *>::const_iterator it = children.constBegin(); it != children.constEnd(); ++it) {
+        if (nodes_.contains(it.value()))
+            continue;       // reached through an earlier property
+        QJsonArray childPath = path;
+        childPath.append(it.key());
+        watch(it.value(), childPath);
+    }
+}
+
+void QJsonJournal::onPropertyNotify()
+{
+    if (paused_ || !file_.isOpen())
+        return;
+
+    QObject *object = sender();
+    QHash<QObject *, Node>::iterator node = nodes_.find(object);
+    if (node == nodes_.end())
+        return;
+    const QStringList properties = node->notifyProperties.value(senderSignalIndex());
+    if (properties.isEmpty())
+        return;
+
+    QByteArray records;
+    QStringList plain;
+    bool rewire = false;
+    for (const QString &name : properties) {
+        if (node->lists.contains(name)) {
+            appendListRecords(records, *node, name);
+            continue;
+        }
+        const QMetaProperty metaproperty = object->metaObject()->property(
+                    object->metaObject()->indexOfProperty(name.toLatin1().constData()));
+        QObject *child = childObject(object, metaproperty);
+        if (child && child == node->children.value(name))
+            continue;       // an edit inside the child; recorded by its own node
+        if (child || node->children.contains(name))
+            rewire = true;
+        plain.append(name);
+    }
+
+    if (!plain.isEmpty()) {
+        const QJsonArray path = node->path;
+        appendRecord(records, [&](QJsonStreamWriter &writer) {
+            if (path.isEmpty()) {
+                QObjectHelper::writeProperties(writer, object, plain);
+                return;
+            }
+            writer.beginObject();
+            writer.writeKey(PathKey);
+            writer.writeValue(path);
+            writer.writeKey(SetKey);
+            QObjectHelper::writeProperties(writer, object, plain);
+            writer.endObject();
+        });
+    }
+    if (rewire)
+        connectNotifySignals();     // a child object was replaced
+    if (records.isEmpty())
+        return;
+
+    if (file_.write(records) != records.size() || !file_.flush()) {
+        qCWarning(lcQJsonHelper) << "Journal[" << file_.fileName() << "]write error: " << file_.errorString();
+        return;
+    }
+    if (file_.size() > compactThreshold_)
+        compact();
+}
+
+// Records the difference between the last recorded value of the array
+// property @p name and its current value: the common head and tail are
+// skipped, the elements in between are updated in place and the
+// remainder is inserted or removed.
+void QJsonJournal::appendListRecords(QByteArray &records, Node &node, const QString &name)
+{
+    const QJsonArray before = node.lists.value(name);
+    const QJsonArray after = node.object->property(name.toLatin1().constData()).toJsonArray();
+    node.lists.insert(name, after);
+
+    const int common = qMin(before.size(), after.size());
+    int head = 0;
+    while (head < common && before.at(head) == after.at(head))
+        ++head;
+    int tail = 0;
+    while (tail < common - head
+           && before.at(before.size() - 1 - tail) == after.at(after.size() - 1 - tail))
+        ++tail;
+
+    QJsonArray path = node.path;
+    path.append(name);
+    const int removed = before.size() - head - tail;
+    const int inserted = after.size() - head - tail;
+    const int updated = qMin(removed, inserted);
+    for (int i = head; i < head + updated; ++i) {
+        if (before.at(i) == after.at(i))
+            continue;
+        QJsonArray elementPath = path;
+        elementPath.append(i);
+        appendElementRecord(records, elementPath, before.at(i), after.at(i));
+    }
+
+    const int at = head + updated;
+    if (removed > inserted) {
+        appendRecord(records, [&](QJsonStreamWriter &writer) {
+            writer.beginObject();
+            writer.writeKey(PathKey);
+            writer.writeValue(path);
+            writer.writeKey(RemoveKey);
+            writer.writeInteger(at);
+            writer.writeKey(CountKey);
+            writer.writeInteger(removed - inserted);
+            writer.endObject();
+        });
+    } else if (inserted > removed) {
+        appendRecord(records, [&](QJsonStreamWriter &writer) {
+            writer.beginObject();
+            writer.writeKey(PathKey);
+            writer.writeValue(path);
+            writer.writeKey(InsertKey);
+            writer.writeInteger(at);
+            writer.writeKey(ValuesKey);
+            writer.beginArray();
+            for (int i = at; i < at + inserted - removed; ++i)
+                writer.writeValue(after.at(i));
+            writer.endArray();
+            writer.endObject();
+        });
+    }
+}
+
+bool QJsonJournal::compact()
+{
+    if (!target_ || !file_.isOpen())
+        return false;
+
+    // The snapshot is replaced atomically before the log is started over.
+    // If we stop in between, the old log still names the old snapshot and
+    // replay() skips it; its records are already in the new snapshot.
+    QSaveFile f(snapshotPath_);
+    if (!f.open(QIODevice::WriteOnly)) {
+        qCWarning(lcQJsonHelper) << "File[" << snapshotPath_ << "]open error: " << f.errorString();
+        return false;
+    }
+    if (!QObjectHelper::writeToDevice(&f, target_, QJsonDocument::Compact, ignoredProperties_)) {
+        f.cancelWriting();
+        return false;
+    }
+    if (!f.commit())
+        return false;
+    return restart(QByteArray());
+}
+
+QJsonJournal::Checkpoint QJsonJournal::checkpoint() const
+{
+    Checkpoint checkpoint;
+    checkpoint.epoch = epoch_;
+    checkpoint.offset = file_.isOpen() ? file_.size() : -1;
+    return checkpoint;
+}
+
+bool QJsonJournal::rebase(const Checkpoint &checkpoint)
+{
+    if (!file_.isOpen())
+        return true;
+    if (checkpoint.epoch != epoch_ || checkpoint.offset < 0 || checkpoint.offset > file_.size())
+        return compact();
+
+    // records of edits made after the snapshot was taken
+    QByteArray later;
+    if (checkpoint.offset < file_.size()) {
+        QFile f(file_.fileName());
+        if (!f.open(QIODevice::ReadOnly) || !f.seek(checkpoint.offset)) {
+            qCWarning(lcQJsonHelper) << "File[" << f.fileName() << "]open error: " << f.errorString();
+            return compact();
+        }
+        later = f.readAll();
+    }
+    return restart(later);
+}
+
+// Empties the log and starts it over against the current snapshot file,
+// followed by @p records.
+bool QJsonJournal::restart(const QByteArray &records)
+{
+    ++epoch_;
+    if (!file_.resize(0) || !writeHeader())
+        return false;
+    if (!records.isEmpty() && (file_.write(records) != records.size() || !file_.flush())) {
+        qCWarning(lcQJsonHelper) << "Journal[" << file_.fileName() << "]write error: " << file_.errorString();
+        return false;
+    }
+    return true;
+}
+
+// False if the first line of the log names another snapshot file. Logs
+// without a header line are taken as current.
+bool QJsonJournal::hasCurrentHeader() const
+{
+    QFile f(file_.fileName());
+    if (!f.open(QIODevice::ReadOnly))
+        return true;
+    const QJsonDocument doc = QJsonDocument::fromJson(f.readLine());
+    const QJsonObject header = doc.object();
+    if (!header.contains(HeaderKey))
+        return true;
+    return header.value(HeaderKey).toString().toLatin1() == snapshotId(snapshotPath_);
+}
+
+bool QJsonJournal::writeHeader()
+{
+    QByteArray header;
+    appendRecord(header, [this](QJsonStreamWriter &writer) {
+        writer.beginObject();
+        writer.writeKey(HeaderKey);
+        writer.writeString(QString::fromLatin1(snapshotId(snapshotPath_)));
+        writer.endObject();
+    });
+    if (file_.write(header) != header.size() || !file_.flush()) {
+        qCWarning(lcQJsonHelper) << "Journal[" << file_.fileName() << "]write error: " << file_.errorString();
+        return false;
+    }
+    return true;
+}
+
+// Content hash of the snapshot file; empty content if it doesn't exist.
+QByteArray QJsonJournal::snapshotId(const QString &snapshotPath)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    QFile f(snapshotPath);
+    if (f.open(QIODevice::ReadOnly))
+        hash.addData(&f);
+    return hash.result().toHex();
+}
+
+int QJsonJournal::replay(const QString &snapshotPath, QObject *object)
+{
+    QFile f(journalPath(snapshotPath));
+    if (!f.exists())
+        return 0;
+    if (!f.open(QIODevice::ReadOnly)) {
+        qCWarning(lcQJsonHelper) << "File[" << f.fileName() << "]open error: " << f.errorString();
+        return -1;
+    }
+
+    int applied = 0;
+    bool first = true;
+    while (!f.atEnd()) {
+        const QByteArray line = f.readLine();
+        if (!line.endsWith('\n'))
+            break;      // record cut short
+
+        QJsonParseError error;
+        const QJsonDocument doc = QJsonDocument::fromJson(line, &error);
+        if (error.error != QJsonParseError::NoError || !doc.isObject()) {
+            qCWarning(lcQJsonHelper) << "Journal[" << f.fileName() << "]bad record: " << error.errorString();
+            break;
+        }
+        const QJsonObject record = doc.object();
+        if (first && record.contains(HeaderKey)) {
+            first = false;
+            if (record.value(HeaderKey).toString().toLatin1() != snapshotId(snapshotPath)) {
+                qCDebug(lcQJsonHelper) << "Journal[" << f.fileName() << "]belongs to an older snapshot, skipped";
+                return 0;
+            }
+            continue;
+        }
+        first = false;
+        if (!applyRecord(record, object)) {
+            qCWarning(lcQJsonHelper) << "Journal[" << f.fileName() << "]record does not apply: " << line.trimmed();
+            break;
+        }
+        ++applied;
+    }
+    return applied;
+}
@@ -0,0 +1,133 @@
+﻿#ifndef QJSONJOURNAL_H
+#define QJSONJOURNAL_H
+
+#include <QtCore/QFile>
+#include <QtCore/QHash>
+#include <QtCore/QJsonArray>
+#include <QtCore/QObject>
+#include <QtCore/QPointer>
+#include <QtCore/QStringList>
+#include <QtCore/QVector>
+
+/**
+* @brief Append-only change log of a QObject's properties.
+*
+* The journal connects to the NOTIFY signal of every readable, writable
+* property of the target. Each notification appends one line to
+* journalPath(snapshotPath) holding a compact json object with the new
+* values of the properties behind that signal:
+*
+* \code
+*   {"name":"Flavio"}
+*   {"x":12,"y":40}
+* \endcode
+*
+* Objects held by QObject* and Q_PROPERTY_QML properties are watched as
+* well and their records carry the property path. QJsonArray properties
+* (the Q_PROPERTY_QMLLIST family) are compared with the previous value and
+* only the elements that changed are written:
+*
+* \code
+*   {"$path":["address"],"$set":{"city":"Rome"}}
+*   {"$path":["items",3],"$set":{"done":true}}
+*   {"$path":["items"],"$insert":4,"$values":[{"title":"new"}]}
+*   {"$path":["items"],"$remove":0,"$count":1}
+* \endcode
+*
+* so the cost of persisting an edit is proportional to the edit. The first
+* line identifies the snapshot the records apply to; replay() applies the
+* records, in order, on top of that snapshot and ignores a log that was
+* written against another one. Once the log grows past compactThreshold()
+* the target is saved to the snapshot file and the log is started over.
+*
+* Whoever else rewrites the snapshot file has to take a checkpoint() when
+* it reads the target and call rebase() once the file is committed, or the
+* records appended afterwards would be skipped by replay() (QJsonHelper's
+* save functions do this).
+*/
+class QJsonJournal : public QObject
+{
+    Q_OBJECT
+
+public:
+    // The journal is a child of @p target unless @p parent is given.
+    explicit QJsonJournal(QObject *target, const QString &snapshotPath, QObject *parent = nullptr);
+    ~QJsonJournal();
+
+    bool open();
+    void close();
+    bool isOpen() const { return file_.isOpen(); }
+
+    // Compaction is attempted after a record brings the log above this size.
+    qint64 compactThreshold() const { return compactThreshold_; }
+    void setCompactThreshold(qint64 bytes) { compactThreshold_ = bytes; }
+
+    QStringList ignoredProperties() const { return ignoredProperties_; }
+    void setIgnoredProperties(const QStringList &properties);
+
+    // While paused, notifications are not recorded (used while loading).
+    // Resuming takes the current state as the base for later records.
+    bool isPaused() const { return paused_; }
+    void setPaused(bool paused);
+
+    QString snapshotPath() const { return snapshotPath_; }
+
+    // Rewrites the snapshot from the target's current state and empties the log.
+    bool compact();
+
+    // Where the log stands when a snapshot of the target is taken.
+    struct Checkpoint {
+        quint64 epoch = 0;      // restarts of the log so far
+        qint64 offset = -1;     // log size
+    };
+
+    Checkpoint checkpoint() const;
+
+    // The snapshot file now holds the target as it was at @p checkpoint:
+    // starts the log over against the new file, keeping the records
+    // written after the checkpoint. If the log was restarted in between
+    // (the file may then be older than the log), compacts instead.
+    bool rebase(const Checkpoint &checkpoint);
+
+    static QString journalPath(const QString &snapshotPath);
+
+    // Applies the records of journalPath(snapshotPath) to @p object. A
+    // truncated last line (e.g. after a crash) ends the replay, and a log
+    // that belongs to an older snapshot is skipped. Returns the number of
+    // records applied, or -1 if the log exists but can't be read.
+    static int replay(const QString &snapshotPath, QObject *object);
+
+private slots:
+    void onPropertyNotify();
+
+private:
+    // A watched object: the target or an object nested in it.
+    struct Node {
+        QPointer<QObject> object;
+        QJsonArray path;                            // property names from the target
+        QHash<int, QStringList> notifyProperties;   // signal index -> property names
+        QHash<QString, QJsonArray> lists;           // last recorded value of array properties
+        QHash<QString, QObject *> children;         // watched object of each property
+    };
+
+    void connectNotifySignals();
+    void disconnectNotifySignals();
+    void watch(QObject *object, const QJsonArray &path);
+    void appendListRecords(QByteArray &records, Node &node, const QString &name);
+    bool writeHeader();
+    bool restart(const QByteArray &records);
+    bool hasCurrentHeader() const;
+
+    static QByteArray snapshotId(const QString &snapshotPath);
+
+    QPointer<QObject> target_;
+    QString snapshotPath_;
+    QFile file_;
+    QStringList ignoredProperties_;
+    QHash<QObject *, Node> nodes_;
+    qint64 compactThreshold_;
+    quint64 epoch_;
+    bool paused_;
+};
+
+#endif // QJSONJOURNAL_H
@@ -0,0 +1,183 @@
+﻿#include "qjsonprojection.h"
+
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonParseError>
+#include <QtCore/QSet>
+
+#include <cstring>
+
+namespace {
+
+inline bool isSpace(char c)
+{
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+inline int skipSpace(const char *data, int size, int pos)
+{
+    while (pos < size && isSpace(data[pos]))
+        ++pos;
+    return pos;
+}
+
+// @p pos is at the opening quote; returns the position after the closing one.
+int skipString(const char *data, int size, int pos)
+{
+    const char *begin = data + pos + 1;
+    const char *p = begin;
+    const char *end = data + size;
+    for (;;) {
+        const char *quote = static_cast<const char *>(std::memchr(p, '"', size_t(end - p)));
+        if (!quote)
+            return -1;
+        // the quote is escaped when preceded by an odd number of backslashes
+        const char *b = quote;
+        while (b > begin && b[-1] == '\\')
+            --b;
+        if ((quote - b) % 2 == 0)
+            return int(quote - data) + 1;
+        p = quote + 1;
+    }
+}
+
+} // namespace
+
+int QJsonProjection::skipValue(const char *data, int size, int pos)
+{
+    pos = skipSpace(data, size, pos);
+    if (pos >= size)
+        return -1;
+
+    const char first = data[pos];
+    if (first == '"')
+        return skipString(data, size, pos);
+
+    if (first == '{' || first == '[') {
+        int depth = 0;
+        while (pos < size) {
+            switch (data[pos]) {
+            case '"':
+                pos = skipString(data, size, pos);
+                if (pos < 0)
+                    return -1;
+                continue;
+            case '{':
+            case '[':
+                ++depth;
+                break;
+            case '}':
+            case ']':
+                if (--depth == 0)
+                    return pos + 1;
+                break;
+            default:
+                break;
+            }
+            ++pos;
+        }
+        return -1;
+    }
+
+    // number, true, false or null
+    while (pos < size) {
+        const char c = data[pos];
+        if (c == ',' || c == '}' || c == ']' || isSpace(c))
+            break;
+        ++pos;
+    }
+    return pos;
+}
+
+/**
+* This method returns the members of the top level object of @p json whose
+* keys are in @p keys. The other members are skipped with skipValue().
+*
+* @param json UTF-8 encoded json text holding an object.
+* @param keys Keys of the members to keep.
+* @param errorString Receives a description of malformed input.
+*/
+QJsonObject QJsonProjection::extract(const QByteArray &json, const QStringList &keys,
+                                     QString *errorString)
+{
+    QSet<QByteArray> wanted;
+    for (const QString &key : keys)
+        wanted.insert(key.toUtf8());
+
+    const char *data = json.constData();
+    const int size = json.size();
+    int pos = 0;
+    if (json.startsWith("\xef\xbb\xbf"))
+        pos = 3;
+
+    QString error;
+    QByteArray selected("{");
+    pos = skipSpace(data, size, pos);
+    if (pos >= size || data[pos] != '{') {
+        error = QStringLiteral("Expected an object");
+    } else {
+        pos = skipSpace(data, size, pos + 1);
+        if (pos < size && data[pos] == '}')
+            pos = -1;   // empty object
+        while (pos >= 0) {
+            if (pos >= size || data[pos] != '"') {
+                error = QStringLiteral("Expected a key");
+                break;
+            }
+            const int keyBegin = pos;
+            const int keyEnd = skipString(data, size, pos);
+            if (keyEnd < 0) {
+                error = QStringLiteral("Unterminated string");
+                break;
+            }
+            pos = skipSpace(data, size, keyEnd);
+            if (pos >= size || data[pos] != ':') {
+                error = QStringLiteral("Expected ':'");
+                break;
+            }
+            const int valueBegin = skipSpace(data, size, pos + 1);
+            const int valueEnd = skipValue(data, size, valueBegin);
+            if (valueEnd < 0 || valueEnd == valueBegin) {
+                error = QStringLiteral("Unexpected end of input");
+                break;
+            }
+
+            QByteArray key = QByteArray::fromRawData(data + keyBegin + 1, keyEnd - keyBegin - 2);
+            if (key.contains('\\')) {
+                // escaped key: let QJsonDocument decode it
+                const QJsonDocument doc = QJsonDocument::fromJson(
+                            '[' + QByteArray(data + keyBegin, keyEnd - keyBegin) + ']');
+                key = doc.array().at(0).toString().toUtf8();
+            }
+            if (wanted.contains(key)) {
+                if (selected.size() > 1)
+                    selected.append(',');
+                selected.append(data + keyBegin, keyEnd - keyBegin);
+                selected.append(':');
+                selected.append(data + valueBegin, valueEnd - valueBegin);
+            }
+
+            pos = skipSpace(data, size, valueEnd);
+            if (pos < size && data[pos] == ',') {
+                pos = skipSpace(data, size, pos + 1);
+            } else if (pos < size && data[pos] == '}') {
+                pos = -1;
+            } else {
+                error = QStringLiteral("Expected ',' or '}'");
+                break;
+            }
+        }
+    }
+
+    if (error.isEmpty()) {
+        selected.append('}');
+        QJsonParseError parseError;
+        const QJsonDocument doc = QJsonDocument::fromJson(selected, &parseError);
+        if (parseError.error == QJsonParseError::NoError)
+            return doc.object();
+        error = parseError.errorString();
+    }
+    if (errorString)
+        *errorString = error;
+    return QJsonObject();
+}
@@ -0,0 +1,37 @@
+﻿#ifndef QJSONPROJECTION_H
+#define QJSONPROJECTION_H
+
+#include <QtCore/QByteArray>
+#include <QtCore/QJsonObject>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+
+/**
+* @brief Picks a few top level members out of a json object without parsing
+* the rest of the document.
+*
+* The text is walked with a structural scanner: strings are skipped with
+* memchr() and containers by bracket counting, so the values of unwanted
+* members are never decoded into a DOM. Only the selected "key": value
+* slices are handed to QJsonDocument. The skipped parts are only checked
+* for balanced brackets and closed strings, not fully validated.
+*
+* \code
+*   QJsonObject settings = QJsonProjection::extract(content,
+*           QStringList() << "theme" << "language");
+* \endcode
+*/
+class QJsonProjection {
+public:
+    // Members of the top level object of @p json whose keys are listed in
+    // @p keys. On malformed input an empty object is returned and
+    // @p errorString, if given, describes the problem.
+    static QJsonObject extract(const QByteArray &json, const QStringList &keys,
+                               QString *errorString = nullptr);
+
+    // End of the json value starting at or after @p pos (leading whitespace
+    // is skipped), or -1 if the input ends inside it.
+    static int skipValue(const char *data, int size, int pos);
+};
+
+#endif // QJSONPROJECTION_H
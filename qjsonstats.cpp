@@ -0,0 +1,86 @@
+﻿#include "qjsonstats.h"
+
+#ifdef QJSONHELPER_ENABLE_STATS
+#include <QtCore/QHash>
+#include <QtCore/QMetaObject>
+#include <QtCore/QMutex>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QVector>
+#endif
+
+Q_LOGGING_CATEGORY(lcQJsonHelper, "qjsonhelper", QtWarningMsg)
+
+#ifdef QJSONHELPER_ENABLE_STATS
+namespace {
+
+struct StatsTable {
+    QMutex lock;
+    QHash<const QMetaObject *, QVector<quint64> > counters;
+};
+
+const char *const CounterNames[QJsonStats::CounterCount] = {
+    "serializeCalls",
+    "deserializeCalls",
+    "bytesWritten",
+    "bytesRead",
+    "objectsCreated",
+    "objectsDestroyed",
+    "nanoseconds"
+};
+
+} // namespace
+
+Q_GLOBAL_STATIC(StatsTable, statsTable)
+#endif
+
+bool QJsonStats::isEnabled()
+{
+#ifdef QJSONHELPER_ENABLE_STATS
+    return true;
+#else
+    return false;
+#endif
+}
+
+void QJsonStats::add(const QMetaObject *metaobject, Counter counter, quint64 amount)
+{
+#ifdef QJSONHELPER_ENABLE_STATS
+    if (!metaobject)
+        return;
+    StatsTable *table = statsTable();
+    QMutexLocker locker(&table->lock);
+    QVector<quint64> &counters = table->counters[metaobject];
+    if (counters.isEmpty())
+        counters.resize(CounterCount);
+    counters[counter] += amount;
+#else
+    Q_UNUSED(metaobject)
+    Q_UNUSED(counter)
+    Q_UNUSED(amount)
+#endif
+}
+
+QVariantMap QJsonStats::snapshot()
+{
+    QVariantMap result;
+#ifdef QJSONHELPER_ENABLE_STATS
+    StatsTable *table = statsTable();
+    QMutexLocker locker(&table->lock);
+    for (auto it = table->counters.constBegin(); it != table->counters.constEnd(); ++it) {
+        QVariantMap counters;
+        for (int i = 0; i < CounterCount; ++i)
+            counters.insert(QLatin1String(CounterNames[i]), it.value().at(i));
+        result.insert(QLatin1String(it.key()->className()), counters);
+    }
+#endif
+    return result;
+}
+
+void QJsonStats::reset()
+{
+#ifdef QJSONHELPER_ENABLE_STATS
+    StatsTable *table = statsTable();
+    QMutexLocker locker(&table->lock);
+    table->counters.clear();
+#endif
+}
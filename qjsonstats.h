@@ -0,0 +1,81 @@
+﻿#ifndef QJSONSTATS_H
+#define QJSONSTATS_H
+
+#include <QtCore/QLoggingCategory>
+#include <QtCore/QVariantMap>
+#ifdef QJSONHELPER_ENABLE_STATS
+#include <QtCore/QElapsedTimer>
+#endif
+
+QT_BEGIN_NAMESPACE
+struct QMetaObject;
+QT_END_NAMESPACE
+
+// Logging category of the library ("qjsonhelper"). Debug output, e.g. the
+// Q_PROPERTY_QMLLIST traces, is off by default; enable it with
+// QT_LOGGING_RULES="qjsonhelper.debug=true".
+Q_DECLARE_LOGGING_CATEGORY(lcQJsonHelper)
+
+/**
+* @brief Per-class serialization counters.
+*
+* Counters are only collected when the library and its users are built with
+* QJSONHELPER_ENABLE_STATS defined (see QJsonHelper.pri). Otherwise the
+* QJSONHELPER_STAT* macros expand to nothing and snapshot() returns an
+* empty map.
+*
+* Times are inclusive: serializing an object also counts the time spent on
+* its nested objects.
+*/
+class QJsonStats {
+public:
+    enum Counter {
+        SerializeCalls,
+        DeserializeCalls,
+        BytesWritten,
+        BytesRead,
+        ObjectsCreated,
+        ObjectsDestroyed,
+        Nanoseconds,
+        CounterCount
+    };
+
+    static bool isEnabled();
+
+    static void add(const QMetaObject *metaobject, Counter counter, quint64 amount = 1);
+
+    // class name -> { "serializeCalls": n, "bytesWritten": n, ... }
+    static QVariantMap snapshot();
+
+    static void reset();
+
+#ifdef QJSONHELPER_ENABLE_STATS
+    // Counts one call on construction and adds the elapsed time on destruction.
+    class Scope {
+    public:
+        Scope(const QMetaObject *metaobject, Counter calls) : metaobject_(metaobject) {
+            add(metaobject_, calls);
+            timer_.start();
+        }
+        ~Scope() {
+            add(metaobject_, Nanoseconds, quint64(timer_.nsecsElapsed()));
+        }
+    private:
+        Q_DISABLE_COPY(Scope)
+        const QMetaObject *metaobject_;
+        QElapsedTimer timer_;
+    };
+#endif
+};
+
+#ifdef QJSONHELPER_ENABLE_STATS
+#  define QJSONHELPER_STAT(METAOBJECT, COUNTER, AMOUNT) \
+        QJsonStats::add((METAOBJECT), QJsonStats::COUNTER, quint64(AMOUNT))
+#  define QJSONHELPER_STAT_SCOPE(METAOBJECT, COUNTER) \
+        QJsonStats::Scope qJsonStatsScope((METAOBJECT), QJsonStats::COUNTER)
+#else
+#  define QJSONHELPER_STAT(METAOBJECT, COUNTER, AMOUNT) do {} while (false)
+#  define QJSONHELPER_STAT_SCOPE(METAOBJECT, COUNTER) do {} while (false)
+#endif
+
+#endif // QJSONSTATS_H
@@ -0,0 +1,193 @@
+﻿#include "qjsonstreamreader.h"
+
+#include <QtCore/QIODevice>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QJsonParseError>
+
+namespace {
+const int DefaultChunkSize = 64 * 1024;
+const int ReadyReadTimeout = 30000;
+
+inline bool isSpace(char c)
+{
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+}
+
+QJsonStreamReader::QJsonStreamReader(QIODevice *device)
+  : device_(device)
+  , pos_(0)
+  , scan_(0)
+  , depth_(0)
+  , inString_(false)
+  , escape_(false)
+  , started_(false)
+  , array_(false)
+  , finished_(false)
+  , chunkSize_(DefaultChunkSize)
+{
+}
+
+/**
+* Drops the consumed part of the buffer and appends the next chunk of the
+* device. Returns false once the device has no more data.
+*/
+bool QJsonStreamReader::fill()
+{
+    if (pos_ > 0) {
+        buffer_.remove(0, pos_);
+        scan_ -= pos_;
+        pos_ = 0;
+    }
+
+    QByteArray chunk = device_->read(chunkSize_);
+    if (chunk.isEmpty() && device_->isSequential() && !device_->atEnd()
+            && device_->waitForReadyRead(ReadyReadTimeout))
+        chunk = device_->read(chunkSize_);
+    if (chunk.isEmpty())
+        return false;
+    buffer_.append(chunk);
+    return true;
+}
+
+/**
+* Skips whitespace (and, inside an array, the separating commas) up to the
+* next element. Returns false at the end of the input.
+*/
+bool QJsonStreamReader::skipSeparators()
+{
+    for (;;) {
+        while (pos_ < buffer_.size()) {
+            const char c = buffer_.at(pos_);
+            if (!started_) {
+                // UTF-8 byte order mark
+                if (pos_ == 0 && buffer_.startsWith("\xef\xbb\xbf")) {
+                    pos_ += 3;
+                    continue;
+                }
+                if (isSpace(c)) {
+                    ++pos_;
+                    continue;
+                }
+                started_ = true;
+                array_ = c == '[';
+                if (array_)
+                    ++pos_;
+                continue;
+            }
+            if (isSpace(c) || (array_ && c == ',')) {
+                ++pos_;
+                continue;
+            }
+            if (array_ && c == ']') {
+                ++pos_;
+                return false;
+            }
+            return true;
+        }
+        if (!fill())
+            return false;
+    }
+}
+
+/**
+* Advances scan_ to the end of the element starting at pos_, reading more
+* input as needed. Returns false if the input ends inside the element.
+*/
+bool QJsonStreamReader::scanElement()
+{
+    scan_ = pos_;
+    depth_ = 0;
+    inString_ = false;
+    escape_ = false;
+
+    for (;;) {
+        const char *data = buffer_.constData();
+        const int size = buffer_.size();
+        for (; scan_ < size; ++scan_) {
+            const char c = data[scan_];
+            if (inString_) {
+                if (escape_)
+                    escape_ = false;
+                else if (c == '\\')
+                    escape_ = true;
+                else if (c == '"') {
+                    inString_ = false;
+                    if (depth_ == 0) {
+                        ++scan_;
+                        return true;
+                    }
+                }
+                continue;
+            }
+            switch (c) {
+            case '"':
+                inString_ = true;
+                break;
+            case '{':
+            case '[':
+                ++depth_;
+                break;
+            case '}':
+            case ']':
+                if (depth_ == 0)
+                    return scan_ > pos_;    // closing bracket of the outer array
+                if (--depth_ == 0) {
+                    ++scan_;
+                    return true;
+                }
+                break;
+            case ',':
+                if (depth_ == 0)
+                    return true;
+                break;
+            default:
+                if (depth_ == 0 && isSpace(c))
+                    return true;
+                break;
+            }
+        }
+        if (!fill()) {
+            // a bare scalar may end with the input
+            return depth_ == 0 && !inString_ && scan_ > pos_;
+        }
+    }
+}
+
+bool QJsonStreamReader::readNext(QJsonValue *value)
+{
+    if (finished_ || hasError())
+        return false;
+
+    if (!skipSeparators()) {
+        finished_ = true;
+        return false;
+    }
+    if (!scanElement()) {
+        error_ = QStringLiteral("Unexpected end of input");
+        return false;
+    }
+
+    const char first = buffer_.at(pos_);
+    const QByteArray element = QByteArray::fromRawData(buffer_.constData() + pos_, scan_ - pos_);
+    QJsonParseError error;
+    if (first == '{' || first == '[') {
+        const QJsonDocument doc = QJsonDocument::fromJson(element, &error);
+        if (error.error == QJsonParseError::NoError)
+            *value = doc.isObject() ? QJsonValue(doc.object()) : QJsonValue(doc.array());
+    } else {
+        // QJsonDocument only parses objects and arrays
+        const QJsonDocument doc = QJsonDocument::fromJson('[' + element + ']', &error);
+        if (error.error == QJsonParseError::NoError)
+            *value = doc.array().at(0);
+    }
+    pos_ = scan_;
+
+    if (error.error != QJsonParseError::NoError) {
+        error_ = error.errorString();
+        return false;
+    }
+    return true;
+}
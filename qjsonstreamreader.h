@@ -0,0 +1,112 @@
+﻿#ifndef QJSONSTREAMREADER_H
+#define QJSONSTREAMREADER_H
+
+#include <QtCore/QByteArray>
+#include <QtCore/QJsonValue>
+#include <QtCore/QList>
+#include <QtCore/QObject>
+#include <QtCore/QString>
+
+#include "qobjecthelper.h"
+
+QT_BEGIN_NAMESPACE
+class QIODevice;
+QT_END_NAMESPACE
+
+/**
+* @brief Reads the elements of a top level JSON array, or of newline
+* delimited JSON (NDJSON), from a QIODevice one at a time.
+*
+* The device is consumed in chunks of chunkSize() bytes and only the
+* element being parsed is held in memory, so memory use is bounded by the
+* largest element rather than by the size of the input. The format is
+* detected from the first character: '[' starts an array, anything else is
+* read as a sequence of whitespace separated values.
+*
+* \code
+*   QFile f(path);
+*   f.open(QIODevice::ReadOnly);
+*   QJsonStreamReader reader(&f);
+*   reader.readObjects<Person>(this, [&](Person *p) {
+*       people.append(p);
+*       return true;            // false stops reading
+*   });
+* \endcode
+*/
+class QJsonStreamReader {
+public:
+    explicit QJsonStreamReader(QIODevice *device);
+
+    // Reads the next element into @p value. Returns false at the end of the
+    // input or on error (see hasError()).
+    bool readNext(QJsonValue *value);
+
+    bool atEnd() const { return finished_; }
+    bool hasError() const { return !error_.isEmpty(); }
+    QString errorString() const { return error_; }
+
+    int chunkSize() const { return chunkSize_; }
+    void setChunkSize(int size) { chunkSize_ = size; }
+
+    // Creates one T (a QObject subclass with a T(QObject *parent)
+    // constructor) per object element, populated with
+    // QObjectHelper::qjsonobject2qobject(), and hands it to @p callback.
+    // The callback returns false to stop. Returns the number of objects
+    // delivered.
+    template <typename T, typename Callback>
+    qint64 readObjects(QObject *parent, Callback callback) {
+        qint64 count = 0;
+        QJsonValue value;
+        while (readNext(&value)) {
+            if (!value.isObject())
+                continue;
+            T *item = new T(parent);
+            QObjectHelper::qjsonobject2qobject(value.toObject(), item);
+            ++count;
+            if (!callback(item))
+                break;
+        }
+        return count;
+    }
+
+    // Same as readObjects(), delivering the objects in lists of up to
+    // @p batchSize items.
+    template <typename T, typename Callback>
+    qint64 readObjectBatches(QObject *parent, int batchSize, Callback callback) {
+        QList<T*> batch;
+        bool more = true;
+        const qint64 count = readObjects<T>(parent, [&](T *item) {
+            batch.append(item);
+            if (batch.size() < batchSize)
+                return true;
+            more = callback(batch);
+            batch.clear();
+            return more;
+        });
+        if (more && !batch.isEmpty())
+            callback(batch);
+        return count;
+    }
+
+private:
+    Q_DISABLE_COPY(QJsonStreamReader)
+
+    bool fill();
+    bool skipSeparators();
+    bool scanElement();
+
+    QIODevice *device_;
+    QByteArray buffer_;
+    int pos_;           // start of the unread input in buffer_
+    int scan_;          // scanner position within the current element
+    int depth_;
+    bool inString_;
+    bool escape_;
+    bool started_;
+    bool array_;
+    bool finished_;
+    int chunkSize_;
+    QString error_;
+};
+
+#endif // QJSONSTREAMREADER_H
@@ -0,0 +1,367 @@
+﻿#include "qjsonstreamwriter.h"
+
+#include <QtCore/QIODevice>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonObject>
+#include <QtCore/QLocale>
+#include <QtCore/QStringList>
+#include <QtCore/QVariantMap>
+#include <QtCore/qmath.h>
+#include <QtCore/qnumeric.h>
+
+#include "qjsonbase64.h"
+
+namespace {
+const int DefaultBufferSize = 64 * 1024;
+const char HexDigits[] = "0123456789abcdef";
+
+// Upper bound of the bytes needed for one UTF-16 unit once escaped and
+// encoded as UTF-8. Surrogates are counted as 3 each, which covers both a
+// lone surrogate (U+FFFD) and half of a 4 byte pair.
+inline int escapedLength(ushort u)
+{
+    if (u < 0x20)
+        return (u == '\b' || u == '\f' || u == '\n' || u == '\r' || u == '\t') ? 2 : 6;
+    if (u < 0x80)
+        return (u == '"' || u == '\\') ? 2 : 1;
+    if (u < 0x800)
+        return 2;
+    return 3;
+}
+}
+
+QJsonStreamWriter::QJsonStreamWriter(QIODevice *device, QJsonDocument::JsonFormat format)
+  : device_(device)
+  , out_(&buffer_)
+  , indented_(format == QJsonDocument::Indented)
+  , afterKey_(false)
+  , error_(false)
+  , bufferSize_(DefaultBufferSize)
+{
+    // reserve() keeps the capacity alive across resize(0) in flush()
+    buffer_.reserve(bufferSize_ + 1024);
+}
+
+QJsonStreamWriter::QJsonStreamWriter(QByteArray *output, QJsonDocument::JsonFormat format)
+  : device_(nullptr)
+  , out_(output)
+  , indented_(format == QJsonDocument::Indented)
+  , afterKey_(false)
+  , error_(false)
+  , bufferSize_(DefaultBufferSize)
+{
+}
+
+QJsonStreamWriter::~QJsonStreamWriter()
+{
+    flush();
+}
+
+void QJsonStreamWriter::newline()
+{
+    if (!indented_)
+        return;
+    out_->append('\n');
+    out_->append(QByteArray(4 * first_.size(), ' '));
+}
+
+void QJsonStreamWriter::beforeValue()
+{
+    if (afterKey_) {
+        afterKey_ = false;
+        return;
+    }
+    if (first_.isEmpty())
+        return;
+    if (!first_.last())
+        out_->append(',');
+    first_.last() = false;
+    newline();
+}
+
+void QJsonStreamWriter::beginObject()
+{
+    beforeValue();
+    out_->append('{');
+    first_.append(true);
+}
+
+void QJsonStreamWriter::endObject()
+{
+    first_.removeLast();
+    newline();
+    out_->append('}');
+    if (indented_ && first_.isEmpty())
+        out_->append('\n');
+    maybeFlush();
+}
+
+void QJsonStreamWriter::beginArray()
+{
+    beforeValue();
+    out_->append('[');
+    first_.append(true);
+}
+
+void QJsonStreamWriter::endArray()
+{
+    first_.removeLast();
+    newline();
+    out_->append(']');
+    if (indented_ && first_.isEmpty())
+        out_->append('\n');
+    maybeFlush();
+}
+
+void QJsonStreamWriter::writeKey(const QString &key)
+{
+    if (!first_.last())
+        out_->append(',');
+    first_.last() = false;
+    newline();
+    appendEscaped(key);
+    out_->append(indented_ ? ": " : ":");
+    afterKey_ = true;
+}
+
+void QJsonStreamWriter::writeNull()
+{
+    beforeValue();
+    out_->append("null");
+}
+
+void QJsonStreamWriter::writeBool(bool value)
+{
+    beforeValue();
+    out_->append(value ? "true" : "false");
+}
+
+void QJsonStreamWriter::writeInteger(qint64 value)
+{
+    beforeValue();
+    out_->append(QByteArray::number(value));
+}
+
+void QJsonStreamWriter::writeDouble(double value)
+{
+    beforeValue();
+    if (!qIsFinite(value)) {
+        out_->append("null");    // same as QJsonDocument
+    } else if (value == qFloor(value) && qAbs(value) < 9007199254740992.0) {
+        out_->append(QByteArray::number(qint64(value)));
+    } else {
+#if QT_VERSION >= QT_VERSION_CHECK(5, 7, 0)
+        out_->append(QByteArray::number(value, 'g', QLocale::FloatingPointShortest));
+#else
+        out_->append(QByteArray::number(value, 'g', 17));
+#endif
+    }
+}
+
+void QJsonStreamWriter::writeString(const QString &value)
+{
+    beforeValue();
+    appendEscaped(value);
+    maybeFlush();
+}
+
+void QJsonStreamWriter::writeBase64(const QByteArray &value)
+{
+    beforeValue();
+    // encoded in place, no temporary Base64 copy of the blob
+    const int offset = out_->size();
+    out_->resize(offset + QJsonBase64::encodedLength(value.size()) + 2);
+    char *dst = out_->data() + offset;
+    *dst++ = '"';
+    QJsonBase64::encode(value.constData(), value.size(), dst);
+    out_->data()[out_->size() - 1] = '"';
+    maybeFlush();
+}
+
+void QJsonStreamWriter::writeValue(const QJsonValue &value)
+{
+    switch (value.type()) {
+    case QJsonValue::Bool:
+        writeBool(value.toBool());
+        break;
+    case QJsonValue::Double:
+        writeDouble(value.toDouble());
+        break;
+    case QJsonValue::String:
+        writeString(value.toString());
+        break;
+    case QJsonValue::Array: {
+        const QJsonArray array = value.toArray();
+        beginArray();
+        for (QJsonArray::const_iterator it = array.constBegin(); it != array.constEnd(); ++it)
+            writeValue(*it);
+        endArray();
+        break;
+    }
+    case QJsonValue::Object: {
+        const QJsonObject object = value.toObject();
+        beginObject();
+        for (QJsonObject::const_iterator it = object.constBegin(); it != object.constEnd(); ++it) {
+            writeKey(it.key());
+            writeValue(it.value());
+        }
+        endObject();
+        break;
+    }
+    default:
+        writeNull();
+        break;
+    }
+}
+
+void QJsonStreamWriter::writeVariant(const QVariant &value)
+{
+    switch (value.userType()) {
+    case QMetaType::UnknownType:
+        writeNull();
+        break;
+    case QMetaType::Bool:
+        writeBool(value.toBool());
+        break;
+    case QMetaType::Short:
+    case QMetaType::UShort:
+    case QMetaType::Int:
+    case QMetaType::UInt:
+    case QMetaType::LongLong:
+        writeInteger(value.toLongLong());
+        break;
+    case QMetaType::Float:
+    case QMetaType::Double:
+    case QMetaType::ULongLong:
+        writeDouble(value.toDouble());
+        break;
+    case QMetaType::QString:
+        writeString(value.toString());
+        break;
+    case QMetaType::QStringList: {
+        const QStringList list = value.toStringList();
+        beginArray();
+        for (const QString &s : list)
+            writeString(s);
+        endArray();
+        break;
+    }
+    case QMetaType::QVariantList: {
+        const QVariantList list = value.toList();
+        beginArray();
+        for (const QVariant &v : list)
+            writeVariant(v);
+        endArray();
+        break;
+    }
+    case QMetaType::QVariantMap: {
+        const QVariantMap map = value.toMap();
+        beginObject();
+        for (QVariantMap::const_iterator it = map.constBegin(); it != map.constEnd(); ++it) {
+            writeKey(it.key());
+            writeVariant(it.value());
+        }
+        endObject();
+        break;
+    }
+    case QMetaType::QVariantHash: {
+        const QVariantHash hash = value.toHash();
+        beginObject();
+        for (QVariantHash::const_iterator it = hash.constBegin(); it != hash.constEnd(); ++it) {
+            writeKey(it.key());
+            writeVariant(it.value());
+        }
+        endObject();
+        break;
+    }
+    case QMetaType::QJsonValue:
+        writeValue(value.value<QJsonValue>());
+        break;
+    case QMetaType::QJsonObject:
+        writeValue(value.value<QJsonObject>());
+        break;
+    case QMetaType::QJsonArray:
+        writeValue(value.value<QJsonArray>());
+        break;
+    default:
+        writeValue(QJsonValue::fromVariant(value));
+        break;
+    }
+}
+
+void QJsonStreamWriter::appendEscaped(const QString &value)
+{
+    const ushort *src = value.utf16();
+    const int n = value.size();
+
+    int length = 2;
+    for (int i = 0; i < n; ++i)
+        length += escapedLength(src[i]);
+
+    const int offset = out_->size();
+    out_->resize(offset + length);
+    char *dst = out_->data() + offset;
+
+    *dst++ = '"';
+    for (int i = 0; i < n; ++i) {
+        const ushort u = src[i];
+        if (u < 0x80) {
+            switch (u) {
+            case '"':  *dst++ = '\\'; *dst++ = '"'; break;
+            case '\\': *dst++ = '\\'; *dst++ = '\\'; break;
+            case '\b': *dst++ = '\\'; *dst++ = 'b'; break;
+            case '\f': *dst++ = '\\'; *dst++ = 'f'; break;
+            case '\n': *dst++ = '\\'; *dst++ = 'n'; break;
+            case '\r': *dst++ = '\\'; *dst++ = 'r'; break;
+            case '\t': *dst++ = '\\'; *dst++ = 't'; break;
+            default:
+                if (u < 0x20) {
+                    *dst++ = '\\'; *dst++ = 'u'; *dst++ = '0'; *dst++ = '0';
+                    *dst++ = HexDigits[u >> 4];
+                    *dst++ = HexDigits[u & 0xf];
+                } else {
+                    *dst++ = char(u);
+                }
+                break;
+            }
+        } else if (u < 0x800) {
+            *dst++ = char(0xc0 | (u >> 6));
+            *dst++ = char(0x80 | (u & 0x3f));
+        } else if (u >= 0xd800 && u < 0xdc00 && i + 1 < n
+                   && src[i + 1] >= 0xdc00 && src[i + 1] < 0xe000) {
+            const uint ucs4 = 0x10000 + ((uint(u) - 0xd800) << 10) + (uint(src[i + 1]) - 0xdc00);
+            ++i;
+            *dst++ = char(0xf0 | (ucs4 >> 18));
+            *dst++ = char(0x80 | ((ucs4 >> 12) & 0x3f));
+            *dst++ = char(0x80 | ((ucs4 >> 6) & 0x3f));
+            *dst++ = char(0x80 | (ucs4 & 0x3f));
+        } else if (u >= 0xd800 && u < 0xe000) {
+            // lone surrogate
+            *dst++ = char(0xef);
+            *dst++ = char(0xbf);
+            *dst++ = char(0xbd);
+        } else {
+            *dst++ = char(0xe0 | (u >> 12));
+            *dst++ = char(0x80 | ((u >> 6) & 0x3f));
+            *dst++ = char(0x80 | (u & 0x3f));
+        }
+    }
+    *dst++ = '"';
+    out_->resize(int(dst - out_->constData()));
+}
+
+void QJsonStreamWriter::maybeFlush()
+{
+    if (device_ && buffer_.size() >= bufferSize_)
+        flush();
+}
+
+bool QJsonStreamWriter::flush()
+{
+    if (!device_ || buffer_.isEmpty())
+        return !error_;
+    if (device_->write(buffer_) != buffer_.size())
+        error_ = true;
+    buffer_.resize(0);
+    return !error_;
+}
@@ -0,0 +1,82 @@
+﻿#ifndef QJSONSTREAMWRITER_H
+#define QJSONSTREAMWRITER_H
+
+#include <QtCore/QByteArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonValue>
+#include <QtCore/QVariant>
+#include <QtCore/QVector>
+
+QT_BEGIN_NAMESPACE
+class QIODevice;
+QT_END_NAMESPACE
+
+/**
+* @brief Writes UTF-8 encoded JSON straight into a QIODevice or QByteArray.
+*
+* Unlike QJsonDocument no intermediate DOM is built: values are formatted
+* into a small internal buffer that is handed to the device whenever it
+* grows past bufferSize(). Output follows QJsonDocument's Compact and
+* Indented layouts, except that object keys keep the order they were
+* written in.
+*
+* \code
+*   QFile f(path);
+*   f.open(QIODevice::WriteOnly | QIODevice::Truncate);
+*   QJsonStreamWriter writer(&f, QJsonDocument::Indented);
+*   writer.beginObject();
+*   writer.writeKey(QStringLiteral("name"));
+*   writer.writeString(QStringLiteral("Flavio"));
+*   writer.endObject();
+*   writer.flush();
+* \endcode
+*/
+class QJsonStreamWriter {
+public:
+    explicit QJsonStreamWriter(QIODevice *device,
+                               QJsonDocument::JsonFormat format = QJsonDocument::Compact);
+    explicit QJsonStreamWriter(QByteArray *output,
+                               QJsonDocument::JsonFormat format = QJsonDocument::Compact);
+    ~QJsonStreamWriter();
+
+    void beginObject();
+    void endObject();
+    void beginArray();
+    void endArray();
+
+    void writeKey(const QString &key);
+
+    void writeNull();
+    void writeBool(bool value);
+    void writeInteger(qint64 value);
+    void writeDouble(double value);
+    void writeString(const QString &value);
+    void writeBase64(const QByteArray &value);
+    void writeValue(const QJsonValue &value);
+    void writeVariant(const QVariant &value);
+
+    bool flush();
+    bool hasError() const { return error_; }
+
+    int bufferSize() const { return bufferSize_; }
+    void setBufferSize(int size) { bufferSize_ = size; }
+
+private:
+    Q_DISABLE_COPY(QJsonStreamWriter)
+
+    void beforeValue();
+    void newline();
+    void appendEscaped(const QString &value);
+    void maybeFlush();
+
+    QIODevice *device_;
+    QByteArray *out_;
+    QByteArray buffer_;
+    QVector<bool> first_;   // one entry per open container: nothing written yet
+    bool indented_;
+    bool afterKey_;
+    bool error_;
+    int bufferSize_;
+};
+
+#endif // QJSONSTREAMWRITER_H
@@ -1,15 +1,33 @@
 ﻿#include "qobjecthelper.h"
 
+#include <QtCore/QMetaEnum>
 #include <QtCore/QMetaObject>
 #include <QtCore/QMetaProperty>
 #include <QtCore/QObject>
+#include <QtCore/QJsonArray>
 #include <QtCore/QJsonDocument>
 #include <QtCore/QJsonObject>
 #include <QtCore/QJsonParseError>
+#include <QtCore/QReadLocker>
+#include <QtCore/QThreadPool>
+#include <QtCore/QWriteLocker>
 #include <QFile>
+#include <QSaveFile>
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+#include <QtCore/QCborArray>
+#include <QtCore/QCborMap>
+#include <QtCore/QCborStreamWriter>
+#include <QtCore/QCborValue>
+#endif
 #include <QDebug>
+#include <QtConcurrent/QtConcurrentMap>
 
 #include "qjsonhelper.h"
+#include "qjsonprojection.h"
+#include "qjsonstats.h"
+#include "qjsonstreamwriter.h"
+#include "qobjecthelper_p.h"
+#include "qobjectsink.h"
 /**
 * @brief Class used to convert QObject into QVariant and vivce-versa.
 * During these operations only the class attributes defined as properties will
@@ -90,6 +108,192 @@ QObjectHelper::~QObjectHelper()
 }
 
 
+typedef QHash<const QMetaObject *, QPropertyPlan *> QPropertyPlanHash;
+Q_GLOBAL_STATIC(QPropertyPlanHash, propertyPlans)
+Q_GLOBAL_STATIC(QReadWriteLock, propertyPlansLock)
+
+QPropertyPlan::QPropertyPlan(const QMetaObject *metaobject, const QJsonFieldTable *fields)
+{
+    const int count = metaobject->propertyCount();
+    entries.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        QPropertyPlanEntry entry;
+        entry.meta = metaobject->property(i);
+        entry.key = QString::fromLatin1(entry.meta.name());
+        entry.type = entry.meta.type();
+        entry.typeId = entry.meta.userType();
+        entry.readable = entry.meta.isReadable();
+        entry.writable = entry.meta.isWritable();
+        entry.pointerToQObject = entry.typeId == QMetaType::QObjectStar
+                || (QMetaType::typeFlags(entry.typeId) & QMetaType::PointerToQObject);
+        entry.field = fields ? fields->find(entry.meta.name()) : nullptr;
+        entry.converter = QJsonConverterRegistry::slot(entry.typeId);
+        entries.append(entry);
+
+        if (entry.readable)
+            readableIndex.append(i);
+        if (entry.writable)
+            writableIndex.insert(entry.key, i);
+    }
+}
+
+/**
+* Returns the property plan of @p object's class, building it on first use.
+* Safe to call from any thread.
+*/
+const QPropertyPlan *QPropertyPlan::get(const QObject *object)
+{
+    const QMetaObject *metaobject = object->metaObject();
+    {
+        QReadLocker locker(propertyPlansLock());
+        QPropertyPlan *plan = propertyPlans()->value(metaobject);
+        if (plan)
+            return plan;
+    }
+
+    QWriteLocker locker(propertyPlansLock());
+    QPropertyPlan *&plan = (*propertyPlans())[metaobject];
+    if (!plan) {
+        const QJsonHelper *helper = qobject_cast<const QJsonHelper *>(object);
+        plan = new QPropertyPlan(metaobject, helper ? helper->jsonFieldTable() : nullptr);
+    }
+    return plan;
+}
+
+QBitArray QPropertyPlan::ignoreMask(const QStringList &ignoredProperties) const
+{
+    if (ignoredProperties.isEmpty())
+        return QBitArray(entries.size());
+
+    const QString cacheKey = ignoredProperties.join(QChar(0x1f));
+    {
+        QReadLocker locker(&maskLock_);
+        QHash<QString, QBitArray>::const_iterator it = masks_.constFind(cacheKey);
+        if (it != masks_.constEnd())
+            return it.value();
+    }
+
+    QBitArray mask(entries.size());
+    for (int i = 0; i < entries.size(); ++i) {
+        if (ignoredProperties.contains(entries.at(i).key))
+            mask.setBit(i);
+    }
+
+    QWriteLocker locker(&maskLock_);
+    // Callers normally pass a handful of fixed lists; do not let ad-hoc
+    // lists grow the cache without bound.
+    if (masks_.size() >= 64)
+        masks_.clear();
+    masks_.insert(cacheKey, mask);
+    return mask;
+}
+
+
+namespace {
+
+thread_local QPropertyWriteLog *openWriteLogs = nullptr;
+
+} // namespace
+
+QPropertyWriteLog::QPropertyWriteLog(QObject *object)
+  : object_(object)
+  , next_(openWriteLogs)
+{
+    openWriteLogs = this;
+}
+
+QPropertyWriteLog::~QPropertyWriteLog()
+{
+    // transactions of different objects need not close in order
+    QPropertyWriteLog **link = &openWriteLogs;
+    while (*link && *link != this)
+        link = &(*link)->next_;
+    if (*link)
+        *link = next_;
+}
+
+void QPropertyWriteLog::record(QObject *object, const QPropertyPlanEntry &entry)
+{
+    for (QPropertyWriteLog *log = openWriteLogs; log; log = log->next_) {
+        if (log->object_ != object)
+            continue;
+        if (entry.readable && entry.meta.hasNotifySignal() && !log->values_.contains(&entry))
+            log->values_.insert(&entry, entry.meta.read(object));
+        return;
+    }
+}
+
+
+namespace {
+
+// Reports one property of @p object to @p sink, preceded by its key.
+// Properties reading as an invalid QVariant are skipped.
+void visitEntry(QObjectSink &sink, const QObject *object, const QPropertyPlanEntry &entry)
+{
+    // typed QByteArray fields produce Base64 text; sinks want the raw bytes
+    if (entry.field && entry.typeId != QMetaType::QByteArray && sink.acceptsTypedFields()) {
+        sink.key(entry.key);
+        sink.jsonValue(entry.field->read(object));
+        return;
+    }
+    const QVariant value = entry.meta.read(object);
+    if (!value.isValid())
+        return;
+
+    sink.key(entry.key);
+    if (value.userType() == QMetaType::QObjectStar) {
+        QObjectHelper::visit(value.value<QObject*>(), sink);
+    } else if (value.canConvert<QList<QObject*>>()) {
+        sink.beginArray();
+        for (QObject *obj : value.value<QList<QObject*>>())
+            QObjectHelper::visit(obj, sink);
+        sink.endArray();
+    } else if (value.userType() == QMetaType::QByteArray) {
+        sink.bytes(value.toByteArray());
+    } else {
+        const QJsonConverter *converter = entry.converter->get();
+        if (converter->toJson)
+            sink.jsonValue(converter->toJson(value));
+        else
+            sink.value(value);
+    }
+}
+
+} // namespace
+
+/**
+* This method walks the properties of a QObject once and reports them to
+* @p sink (see QObjectSink). Every conversion to QJsonObject, QVariantMap,
+* json text and CBOR goes through here, so they all treat nested objects,
+* object lists and byte arrays the same way:
+* - QObject* properties are visited recursively (null pointers are reported
+*   as null);
+* - QList<QObject*> properties become arrays of objects;
+* - QByteArray properties are reported as bytes, which text formats store
+*   as Base64.
+*
+* @param object The QObject instance to visit.
+* @param sink Receives the object.
+* @param ignoredProperties Properties that won't be visited.
+*/
+void QObjectHelper::visit(const QObject *object, QObjectSink &sink, const QStringList &ignoredProperties)
+{
+    if (!object) {
+        sink.nullValue();
+        return;
+    }
+
+    QJSONHELPER_STAT_SCOPE(object->metaObject(), SerializeCalls);
+    const QPropertyPlan *plan = QPropertyPlan::get(object);
+    const QBitArray ignored = plan->ignoreMask(ignoredProperties);
+
+    sink.beginObject();
+    for (int i : plan->readableIndex) {
+        if (!ignored.testBit(i))
+            visitEntry(sink, object, plan->entries.at(i));
+    }
+    sink.endObject();
+}
 
 /**
 * This method converts a QObject instance into a QJsonObject.
@@ -100,154 +304,752 @@ QObjectHelper::~QObjectHelper()
 QJsonObject QObjectHelper::qobject2qjsonobject( const QObject* object,
                               const QStringList& ignoredProperties)
 {
-    QJsonObject result;
-    const QMetaObject *metaobject = object->metaObject();
-    int count = metaobject->propertyCount();
-    for (int i=0; i<count; ++i) {
-        QMetaProperty metaproperty = metaobject->property(i);
-        const char *name = metaproperty.name();
-
-        if (ignoredProperties.contains(QLatin1String(name)) || (!metaproperty.isReadable()))
-            continue;
-
-        QVariant value = object->property(name);
-        result.insert(QLatin1String(name), QJsonValue::fromVariant(value));
-    }
-    return result;
+    QJsonObjectSink sink;
+    visit(object, sink, ignoredProperties);
+    return sink.result();
 }
 
+/**
+* This method converts a QObject instance into a QVariantMap, e.g. for QML.
+*
+* @param object The QObject instance to be converted.
+* @param ignoredProperties Properties that won't be converted.
+*/
 QVariantMap QObjectHelper::qobject2variantmap(const QObject* object,
                                               const QStringList& ignoredProperties)
 {
-    QVariantMap result;
-    if (!object) return result;
+    QVariantMapSink sink;
+    visit(object, sink, ignoredProperties);
+    return sink.result();
+}
 
-    const QMetaObject* metaobject = object->metaObject();
-    int count = metaobject->propertyCount();
+/**
+* This method converts a QObject instance into a compact json string. The
+* text is written by QJsonStreamWriter, without an intermediate
+* QJsonObject, so keys keep the property order.
+*
+* @param object The QObject instance to be converted.
+* @param ignoredProperties Properties that won't be converted.
+*/
+QString QObjectHelper::qobject2json(const QObject *object, const QStringList &ignoredProperties)
+{
+    if (!object)
+        return QStringLiteral("{}");
+    QByteArray json;
+    QJsonStreamWriter writer(&json, QJsonDocument::Compact);
+    writeQObject(writer, object, ignoredProperties);
+    writer.flush();
+    return QString::fromUtf8(json);
+}
 
-    for (int i = 0; i < count; ++i) {
-        QMetaProperty metaproperty = metaobject->property(i);
-        const char* name = metaproperty.name();
 
-        if (!metaproperty.isReadable())
-            continue;
-        if (ignoredProperties.contains(QLatin1String(name)))
-            continue;
+/**
+* This method writes a QObject instance as a JSON object into @p writer,
+* without building an intermediate QJsonObject.
+*
+* @param writer The writer receiving the JSON object.
+* @param object The QObject instance to be converted.
+* @param ignoredProperties Properties that won't be converted.
+*/
+void QObjectHelper::writeQObject(QJsonStreamWriter &writer, const QObject *object,
+                                 const QStringList &ignoredProperties)
+{
+    QJsonWriterSink sink(writer);
+    visit(object, sink, ignoredProperties);
+}
 
-        QVariant value = object->property(name);
-        if (!value.isValid())
-            continue;
+/**
+* This method writes a JSON object holding only the listed properties of
+* @p object, converted the same way writeQObject() converts them. Unknown,
+* read-only and unreadable names are skipped.
+*
+* @param writer The writer receiving the JSON object.
+* @param object The QObject instance to be converted.
+* @param properties Names of the properties to write.
+*/
+void QObjectHelper::writeProperties(QJsonStreamWriter &writer, const QObject *object,
+                                    const QStringList &properties)
+{
+    const QPropertyPlan *plan = QPropertyPlan::get(object);
+    QJsonWriterSink sink(writer);
 
-        // QObject*（嵌套模型）递归处理
-        if (value.userType() == QMetaType::QObjectStar) {
-            QObject* child = value.value<QObject*>();
-            result.insert(name, child ? qobject2variantmap(child) : QVariantMap());
-        }
-        // QObjectList / QList<QObject*>
-        else if (value.canConvert<QList<QObject*>>()) {
-            QVariantList list;
-            auto objs = value.value<QList<QObject*>>();
-            for (QObject* obj : objs)
-                list.append(obj ? qobject2variantmap(obj) : QVariant());
-            result.insert(name, list);
-        }
-        // QByteArray → Base64（和你 json2qobject 对称）
-        else if (value.userType() == QMetaType::QByteArray) {
-            QByteArray ba = value.toByteArray();
-            result.insert(name, QString::fromUtf8(ba.toBase64()));
-        }
-        // 普通类型（int / double / string / map / list）
-        else {
-            result.insert(name, value);
-        }
+    sink.beginObject();
+    for (const QString &name : properties) {
+        const QPropertyPlanEntry *entry = plan->writableEntry(name);
+        if (entry && entry->readable)
+            visitEntry(sink, object, *entry);
     }
-    return result;
+    sink.endObject();
 }
 
-
 /**
-* This method converts a QObject instance into a json string.
+* This method writes a QObject instance as UTF-8 JSON into @p device.
+* Output is buffered; at most one buffer's worth of text is held in memory.
 *
+* @param device An open, writable device.
 * @param object The QObject instance to be converted.
+* @param format Compact or indented output.
 * @param ignoredProperties Properties that won't be converted.
+* @return false if the device reported a write error.
 */
-QString QObjectHelper::qobject2json(const QObject *object, const QStringList &ignoredProperties)
+bool QObjectHelper::writeToDevice(QIODevice *device, const QObject *object,
+                                  QJsonDocument::JsonFormat format,
+                                  const QStringList &ignoredProperties)
 {
-    QString result("");
-    QJsonObject jsonobj = QObjectHelper::qobject2qjsonobject(object, ignoredProperties);
-    QJsonDocument doc(jsonobj);
-    return doc.toJson(QJsonDocument::Compact);
+#ifdef QJSONHELPER_ENABLE_STATS
+    const qint64 start = device->pos();
+#endif
+    QJsonStreamWriter writer(device, format);
+    writeQObject(writer, object, ignoredProperties);
+    const bool ok = writer.flush();
+    QJSONHELPER_STAT(object ? object->metaObject() : nullptr, BytesWritten, device->pos() - start);
+    return ok;
+}
+
+
+namespace {
+
+// Writes one json value to the property described by @p entry: through
+// the typed field if any, into an existing child for QObject* properties,
+// then the property's converter, enum key names and QVariant::convert().
+void writeJsonProperty(QObject *object, const QPropertyPlanEntry *entry, const QJsonValue &json)
+{
+    QPropertyWriteLog::record(object, *entry);
+    if (entry->field && entry->field->write(object, json))
+        return;
+    const QMetaProperty &metaproperty = entry->meta;
+    if (entry->pointerToQObject && json.isObject()) {
+        // 嵌套模型：写入已有的子对象
+        QObject *child = metaproperty.read(object).value<QObject*>();
+        if (child)
+            QObjectHelper::qjsonobject2qobject(json.toObject(), child);
+        return;
+    }
+    QVariant v;
+    const QJsonConverter *converter = entry->converter->get();
+    if (converter->fromJson && converter->fromJson(json, v)) {
+        metaproperty.write(object, v);
+        return;
+    }
+    if (metaproperty.isEnumType() && json.isString()) {
+        // 枚举可以按名字给出 / enums may be given by key name
+        bool ok = false;
+        const QByteArray keys = json.toString().toLatin1();
+        const QMetaEnum enumerator = metaproperty.enumerator();
+        const int value = enumerator.isFlag() ? enumerator.keysToValue(keys.constData(), &ok)
+                                              : enumerator.keyToValue(keys.constData(), &ok);
+        if (ok) {
+            metaproperty.write(object, value);
+            return;
+        }
+    }
+    QVariant::Type type = entry->type;
+    v = QVariant(json);
+    if (v.canConvert(type)) {
+        v.convert(type);
+        metaproperty.write(object, v);
+    }
+    else if (json.isString()) {
+        QVariant v1(json.toString());
+        if (v1.canConvert(type)) {
+            v1.convert(type);
+            metaproperty.write(object, v1);
+        }
+    }
 }
 
+} // namespace
 
 /**
 * This method converts a QVariantMap instance into a QObject
+* Each property's converter (see QJsonConverterRegistry) is resolved once in
+* the property plan, so dispatch does not depend on the property type; values
+* no converter accepts go through QVariant::convert().
 *
 * @param variant Attributes to assign to the object.
 * @param object The QObject instance to update.
 */
 void QObjectHelper::qjsonobject2qobject(const QJsonObject& jsonobj, QObject* object)
 {
-    const QMetaObject *metaobject = object->metaObject();
+    QJSONHELPER_STAT_SCOPE(object->metaObject(), DeserializeCalls);
+    const QPropertyPlan *plan = QPropertyPlan::get(object);
     QJsonObject::const_iterator iter;
     for (iter = jsonobj.constBegin(); iter != jsonobj.constEnd(); ++iter) {
-        int pIdx = metaobject->indexOfProperty(iter.key().toLatin1());
+        const QPropertyPlanEntry *entry = plan->writableEntry(iter.key());
+        if (entry)
+            writeJsonProperty(object, entry, iter.value());
+    }
+}
 
-        if (pIdx < 0) {
+
+/**
+* This method updates a QObject that currently reflects @p previous so that it
+* reflects @p jsonobj, writing only the keys whose value changed. Properties
+* whose key was dropped since @p previous are reset if they are resettable.
+*
+* @param jsonobj Attributes to assign to the object.
+* @param previous Attributes the object was last populated from.
+* @param object The QObject instance to update.
+*/
+void QObjectHelper::qjsonobject2qobject(const QJsonObject &jsonobj, const QJsonObject &previous, QObject *object)
+{
+    QJsonObject changed;
+    QJsonObject::const_iterator iter;
+    for (iter = jsonobj.constBegin(); iter != jsonobj.constEnd(); ++iter) {
+        QJsonObject::const_iterator before = previous.constFind(iter.key());
+        if (before == previous.constEnd() || before.value() != iter.value())
+            changed.insert(iter.key(), iter.value());
+    }
+    if (!changed.isEmpty())
+        QObjectHelper::qjsonobject2qobject(changed, object);
+
+    const QPropertyPlan *plan = QPropertyPlan::get(object);
+    for (iter = previous.constBegin(); iter != previous.constEnd(); ++iter) {
+        if (jsonobj.contains(iter.key()))
             continue;
+        const QPropertyPlanEntry *entry = plan->writableEntry(iter.key());
+        if (entry && entry->meta.isResettable()) {
+            QPropertyWriteLog::record(object, *entry);
+            entry->meta.reset(object);
+        }
+    }
+}
+
+
+namespace {
+
+// RFC 6901 JSON pointer segments: "~" is written "~0" and "/" is "~1".
+QString escapePointerSegment(QString segment)
+{
+    return segment.replace(QLatin1Char('~'), QLatin1String("~0"))
+                  .replace(QLatin1Char('/'), QLatin1String("~1"));
+}
+
+QStringList splitPointer(const QString &pointer)
+{
+    QStringList segments = pointer.split(QLatin1Char('/'));
+    segments.removeFirst();     // the pointer starts with "/"
+    for (QString &segment : segments)
+        segment.replace(QLatin1String("~1"), QLatin1String("/")).replace(QLatin1String("~0"), QLatin1String("~"));
+    return segments;
+}
+
+QJsonObject patchOperation(const QString &op, const QString &path, const QJsonValue &value = QJsonValue::Undefined)
+{
+    QJsonObject operation;
+    operation.insert(QStringLiteral("op"), op);
+    operation.insert(QStringLiteral("path"), path);
+    if (!value.isUndefined())
+        operation.insert(QStringLiteral("value"), value);
+    return operation;
+}
+
+void diffValue(const QString &path, const QJsonValue &from, const QJsonValue &to, QJsonArray &patch)
+{
+    if (from == to)
+        return;
+
+    if (from.isObject() && to.isObject()) {
+        const QJsonObject a = from.toObject();
+        const QJsonObject b = to.toObject();
+        for (QJsonObject::const_iterator it = a.constBegin(); it != a.constEnd(); ++it) {
+            if (!b.contains(it.key()))
+                patch.append(patchOperation(QStringLiteral("remove"), path + QLatin1Char('/') + escapePointerSegment(it.key())));
         }
-        QMetaProperty metaproperty = metaobject->property(pIdx);
-        QVariant::Type type = metaproperty.type();
-        QVariant v(iter.value());
-        if (type == QMetaType::QJsonObject){
-             QJsonValue jv(iter.value());
-             metaproperty.write(object, jv.toObject());
-        } else if (type == QMetaType::QJsonArray){
-            QJsonValue jv(iter.value());
-            metaproperty.write(object, jv.toArray());
-        } else if (type == QMetaType::QByteArray)
-        {
-            // Base64 一定是字符串
-            QString s = iter.value().toString();
-
-            // 去掉可能的空白 / 换行（防御性）
-            QByteArray raw = QByteArray::fromBase64(
-                s.toUtf8(),
-                QByteArray::Base64Encoding
-                );
-
-            if (raw.isEmpty() && !s.isEmpty()) {
-                qWarning() << "Base64 decode failed";
+        for (QJsonObject::const_iterator it = b.constBegin(); it != b.constEnd(); ++it) {
+            const QString childPath = path + QLatin1Char('/') + escapePointerSegment(it.key());
+            QJsonObject::const_iterator before = a.constFind(it.key());
+            if (before == a.constEnd())
+                patch.append(patchOperation(QStringLiteral("add"), childPath, it.value()));
+            else
+                diffValue(childPath, before.value(), it.value(), patch);
+        }
+        return;
+    }
+
+    if (from.isArray() && to.isArray()) {
+        // Element-wise: common prefix first, then the tail is appended or
+        // removed (from the back, so earlier indices stay valid).
+        const QJsonArray a = from.toArray();
+        const QJsonArray b = to.toArray();
+        const int common = qMin(a.size(), b.size());
+        for (int i = 0; i < common; ++i)
+            diffValue(path + QLatin1Char('/') + QString::number(i), a.at(i), b.at(i), patch);
+        for (int i = common; i < b.size(); ++i)
+            patch.append(patchOperation(QStringLiteral("add"), path + QLatin1Char('/') + QString::number(i), b.at(i)));
+        for (int i = a.size() - 1; i >= common; --i)
+            patch.append(patchOperation(QStringLiteral("remove"), path + QLatin1Char('/') + QString::number(i)));
+        return;
+    }
+
+    patch.append(patchOperation(QStringLiteral("replace"), path, to));
+}
+
+// Applies one add / remove / replace operation to @p node, where @p path
+// (from @p depth on) is relative to @p node.
+bool patchValue(QJsonValue &node, const QStringList &path, int depth, const QString &op, const QJsonValue &value)
+{
+    const QString &segment = path.at(depth);
+    const bool last = depth + 1 == path.size();
+
+    if (node.isObject()) {
+        QJsonObject object = node.toObject();
+        if (last) {
+            if (op == QLatin1String("remove")) {
+                if (!object.contains(segment))
+                    return false;
+                object.remove(segment);
+            } else {
+                if (op == QLatin1String("replace") && !object.contains(segment))
+                    return false;
+                object.insert(segment, value);
             }
+        } else {
+            QJsonValue child = object.value(segment);
+            if (!patchValue(child, path, depth + 1, op, value))
+                return false;
+            object.insert(segment, child);
+        }
+        node = object;
+        return true;
+    }
 
-            metaproperty.write(object, raw);
-        }else if (type == QMetaType::QStringList && iter->type() == QJsonValue::Array){
-            QJsonValue jv(iter.value());
-            QJsonArray ja = jv.toArray();
-            QStringList sl;
-            for (int i=0; i<ja.size(); i++)
-            {
-                sl.append(ja[i].toString());
+    if (node.isArray()) {
+        QJsonArray array = node.toArray();
+        bool ok = true;
+        const int index = segment == QLatin1String("-") ? array.size() : segment.toInt(&ok);
+        if (!ok || index < 0 || index > array.size())
+            return false;
+        if (last) {
+            if (op == QLatin1String("add")) {
+                array.insert(index, value);
+            } else if (index == array.size()) {
+                return false;
+            } else if (op == QLatin1String("remove")) {
+                array.removeAt(index);
+            } else {
+                array.replace(index, value);
             }
-            metaproperty.write(object, sl);
+        } else {
+            if (index == array.size())
+                return false;
+            QJsonValue child = array.at(index);
+            if (!patchValue(child, path, depth + 1, op, value))
+                return false;
+            array.replace(index, child);
         }
-        else if (v.canConvert(type)) {
-            v.convert(type);
-            metaproperty.write(object, v);
-        }else if (QString(QLatin1String("QVariant")).compare(QLatin1String(metaproperty.typeName())) == 0) {
-            metaproperty.write(object, v);
+        node = array;
+        return true;
+    }
+
+    return false;
+}
+
+// QMetaObject of the element type of a QList<T*> property, used to create
+// the elements an "add" operation inserts. T needs a Q_INVOKABLE
+// constructor taking the parent.
+const QMetaObject *listElementMetaObject(const QMetaProperty &property)
+{
+    const QByteArray type = property.typeName();
+    if (!type.startsWith("QList<") || !type.endsWith('>'))
+        return nullptr;
+    const QByteArray element = type.mid(6, type.size() - 7).trimmed();
+    const int typeId = QMetaType::type(element.constData());
+    if (typeId == QMetaType::UnknownType || !(QMetaType::typeFlags(typeId) & QMetaType::PointerToQObject))
+        return nullptr;
+    return QMetaType::metaObjectForType(typeId);
+}
+
+// Adds or removes one element of the QList<QObject*> property of @p entry.
+// Removed elements owned by @p object are deleted. The edited list is
+// converted to the property's own QList<T*> type, which needs the
+// converter QObjectHelper::registerObjectList<T>() registers.
+bool patchObjectList(QObject *object, const QPropertyPlanEntry &entry, QList<QObject*> objs,
+                     const QString &op, const QString &segment, const QJsonValue &value)
+{
+    if (!QMetaType::hasRegisteredConverterFunction(qMetaTypeId<QList<QObject*>>(), entry.typeId)) {
+        qCWarning(lcQJsonHelper) << "applyPatch: can't add or remove elements of" << entry.key
+                                 << "without QObjectHelper::registerObjectList<T>()";
+        return false;
+    }
+
+    bool ok = true;
+    const int index = segment == QLatin1String("-") && op == QLatin1String("add")
+            ? objs.size() : segment.toInt(&ok);
+    if (!ok || index < 0 || index > objs.size() || (op == QLatin1String("remove") && index == objs.size()))
+        return false;
+
+    QObject *removed = nullptr;
+    if (op == QLatin1String("add")) {
+        const QMetaObject *metaobject = listElementMetaObject(entry.meta);
+        QObject *item = metaobject ? metaobject->newInstance(Q_ARG(QObject*, object)) : nullptr;
+        if (!item) {
+            qCWarning(lcQJsonHelper) << "applyPatch: can't create an element of" << entry.key
+                                     << "(needs a Q_INVOKABLE constructor taking the parent)";
+            return false;
         }
-        else if (iter->type() == QJsonValue::String) {
-            QJsonValue jv(iter.value());
-            QVariant v1(jv.toString());
-            if (v1.canConvert(type)) {
-                v1.convert(type);
-                metaproperty.write(object, v1);
+        QObjectHelper::qjsonvalue2qobject(value, item);
+        objs.insert(index, item);
+    } else {
+        removed = objs.takeAt(index);
+    }
+
+    QVariant list = QVariant::fromValue(objs);
+    QPropertyWriteLog::record(object, entry);
+    if (!list.convert(entry.typeId) || !entry.meta.write(object, list)) {
+        qCWarning(lcQJsonHelper) << "applyPatch: can't add or remove elements of" << entry.key;
+        if (!removed)
+            delete objs.at(index);
+        return false;
+    }
+    if (removed && removed->parent() == object)
+        removed->deleteLater();
+    return true;
+}
+
+} // namespace
+
+/**
+* This method compares two QObject instances and returns the RFC 6902
+* (JSON Patch) operations that turn the state of @p from into the state
+* of @p to. Both objects are compared through qobject2variantmap(), so
+* nested QObject* and QList<QObject*> values are compared member by member
+* and only the differing leaves show up in the patch.
+*
+* @param from The QObject instance the patch starts from.
+* @param to The QObject instance the patch leads to.
+* @param ignoredProperties Properties that won't be compared.
+*/
+QJsonArray QObjectHelper::diff(const QObject *from, const QObject *to, const QStringList &ignoredProperties)
+{
+    return diff(QJsonObject::fromVariantMap(qobject2variantmap(from, ignoredProperties)),
+                QJsonObject::fromVariantMap(qobject2variantmap(to, ignoredProperties)));
+}
+
+/**
+* This method returns the RFC 6902 operations that turn @p from into @p to.
+* Arrays are compared element by element; extra elements are added or
+* removed at the end.
+*/
+QJsonArray QObjectHelper::diff(const QJsonObject &from, const QJsonObject &to)
+{
+    QJsonArray patch;
+    diffValue(QString(), from, to, patch);
+    return patch;
+}
+
+/**
+* This method applies an RFC 6902 patch (as produced by diff()) to a
+* QObject, writing only the properties the patch touches, each at most
+* once.
+*
+* Paths into a nested QObject* property, or into an element of a
+* QList<QObject*> property, are applied to that object. Other nested paths
+* edit a copy of the property's json value, which is written back after
+* the whole patch was processed. Removing a top level property resets it.
+* Only "add", "remove" and "replace" are supported. Elements of a writable
+* QList<T*> property can be added (the new element is a child of
+* @p object) and removed (removed children of @p object are deleted) once
+* registerObjectList<T>() was called; T needs a Q_INVOKABLE constructor
+* taking the parent, e.g. Q_INVOKABLE explicit T(QObject *parent = nullptr).
+*
+* @param object The QObject instance to update.
+* @param patch The operations to apply.
+* @return false if any operation could not be applied; the others are
+* still applied.
+*/
+bool QObjectHelper::applyPatch(QObject *object, const QJsonArray &patch)
+{
+    const QPropertyPlan *plan = QPropertyPlan::get(object);
+    QJsonObject pending;
+    bool ok = true;
+
+    for (const QJsonValue &item : patch) {
+        const QJsonObject operation = item.toObject();
+        const QString op = operation.value(QStringLiteral("op")).toString();
+        const QString pointer = operation.value(QStringLiteral("path")).toString();
+        const QJsonValue value = operation.value(QStringLiteral("value"));
+
+        if (op != QLatin1String("add") && op != QLatin1String("remove") && op != QLatin1String("replace")) {
+            qCWarning(lcQJsonHelper) << "applyPatch: unsupported op" << op;
+            ok = false;
+            continue;
+        }
+        if (!pointer.startsWith(QLatin1Char('/'))) {
+            ok = false;
+            continue;
+        }
+
+        const QStringList path = splitPointer(pointer);
+        const QString &key = path.first();
+        const QPropertyPlanEntry *entry = plan->writableEntry(key);
+        if (!entry) {
+            ok = false;
+            continue;
+        }
+
+        if (path.size() == 1) {
+            if (op == QLatin1String("remove")) {
+                pending.remove(key);
+                if (entry->meta.isResettable()) {
+                    QPropertyWriteLog::record(object, *entry);
+                    entry->meta.reset(object);
+                } else
+                    ok = false;
+            } else {
+                pending.insert(key, value);
             }
+            continue;
+        }
+
+        const QVariant current = entry->meta.read(object);
+        QObject *child = nullptr;
+        int skip = 1;
+        if (entry->pointerToQObject) {
+            child = current.value<QObject*>();
+        } else if (current.canConvert<QList<QObject*>>()) {
+            const QList<QObject*> objs = current.value<QList<QObject*>>();
+            if (path.size() == 2 && op != QLatin1String("replace")) {
+                ok = patchObjectList(object, *entry, objs, op, path.at(1), value) && ok;
+                continue;
+            }
+            bool isIndex = false;
+            const int index = path.at(1).toInt(&isIndex);
+            if (!isIndex || index < 0 || index >= objs.size()) {
+                ok = false;
+                continue;
+            }
+            child = objs.at(index);
+            skip = 2;
+        }
+
+        if (child && skip == path.size()) {
+            qjsonvalue2qobject(value, child);      // "replace" of a whole element
+            continue;
+        }
+        if (child) {
+            QString childPointer;
+            for (int i = skip; i < path.size(); ++i)
+                childPointer += QLatin1Char('/') + escapePointerSegment(path.at(i));
+            QJsonArray childPatch;
+            childPatch.append(patchOperation(op, childPointer, value));
+            ok = applyPatch(child, childPatch) && ok;
+            continue;
+        }
+        if (entry->pointerToQObject) {
+            ok = false;
+            continue;
+        }
+
+        QJsonValue json = pending.contains(key) ? pending.value(key) : QJsonValue::fromVariant(current);
+        if (patchValue(json, path, 1, op, value))
+            pending.insert(key, json);
+        else
+            ok = false;
+    }
+
+    if (!pending.isEmpty())
+        qjsonobject2qobject(pending, object);
+    return ok;
+}
+
+
+/**
+* This method converts a QJsonValue holding a json object into a QObject.
+* Values of any other type leave the object untouched.
+*
+* @param jsonval Attributes to assign to the object.
+* @param object The QObject instance to update.
+*/
+void QObjectHelper::qjsonvalue2qobject(const QJsonValue &jsonval, QObject *object)
+{
+    if (jsonval.isObject())
+        QObjectHelper::qjsonobject2qobject(jsonval.toObject(), object);
+}
+
+
+namespace {
+
+// Writes one QVariant to the property described by @p entry, applying the
+// same conversions as QObjectHelper::qjsonobject2qobject(). Values that
+// already have the property's type are written as they are when json
+// would lose them (raw bytes, 64-bit integers) or when the type has no
+// converter; everything else goes through writeJsonProperty(), so custom
+// converters, enum key names and blob references apply here too.
+void writeVariantProperty(QObject *object, const QPropertyPlanEntry *entry, const QVariant &value)
+{
+    QPropertyWriteLog::record(object, *entry);
+    const int valueType = value.userType();
+    if (entry->typeId == QMetaType::QVariant) {
+        entry->meta.write(object, value);
+        return;
+    }
+    if (valueType == entry->typeId) {
+        switch (valueType) {
+        case QMetaType::QByteArray:
+        case QMetaType::Int:
+        case QMetaType::UInt:
+        case QMetaType::LongLong:
+        case QMetaType::ULongLong:
+            entry->meta.write(object, value);
+            return;
+        default:
+            if (!entry->converter->get()->fromJson) {
+                entry->meta.write(object, value);
+                return;
+            }
+        }
+    }
+    if (entry->pointerToQObject && valueType == QMetaType::QVariantMap) {
+        QObject *child = entry->meta.read(object).value<QObject*>();
+        if (child)
+            QObjectHelper::qvariantmap2qobject(value.toMap(), child);
+        return;
+    }
+    writeJsonProperty(object, entry, valueType == QMetaType::QJsonValue ? value.value<QJsonValue>()
+                                                                        : QJsonValue::fromVariant(value));
+}
+
+} // namespace
+
+/**
+* This method assigns the entries of a QVariantMap to the properties of a
+* QObject directly, without a json text round trip. It applies the same
+* conversions as qjsonobject2qobject(), including registered converters:
+* Base64 strings, blob references (or raw bytes) for QByteArray, lists for
+* QStringList, enum key names, and maps for nested QObject* properties.
+*
+* @param map Attributes to assign to the object.
+* @param object The QObject instance to update.
+*/
+void QObjectHelper::qvariantmap2qobject(const QVariantMap &map, QObject *object)
+{
+    QJSONHELPER_STAT_SCOPE(object->metaObject(), DeserializeCalls);
+    const QPropertyPlan *plan = QPropertyPlan::get(object);
+    QVariantMap::const_iterator iter;
+    for (iter = map.constBegin(); iter != map.constEnd(); ++iter) {
+        const QPropertyPlanEntry *entry = plan->writableEntry(iter.key());
+        if (entry)
+            writeVariantProperty(object, entry, iter.value());
+    }
+}
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+/**
+* This method converts a QObject instance into a QCborMap.
+* QByteArray values are stored as native CBOR byte strings and integers
+* keep their integer encoding.
+*
+* @param object The QObject instance to be converted.
+* @param ignoredProperties Properties that won't be converted.
+*/
+QCborMap QObjectHelper::qobject2qcbormap(const QObject *object, const QStringList &ignoredProperties)
+{
+    QCborMapSink sink;
+    visit(object, sink, ignoredProperties);
+    return sink.result();
+}
+
+/**
+* This method assigns the entries of a QCborMap to the properties of a
+* QObject. Byte strings are written to QByteArray properties as is; every
+* other value goes through the same conversions as qvariantmap2qobject().
+*
+* @param map Attributes to assign to the object.
+* @param object The QObject instance to update.
+*/
+void QObjectHelper::qcbormap2qobject(const QCborMap &map, QObject *object)
+{
+    QJSONHELPER_STAT_SCOPE(object->metaObject(), DeserializeCalls);
+    const QPropertyPlan *plan = QPropertyPlan::get(object);
+    for (QCborMap::const_iterator iter = map.constBegin(); iter != map.constEnd(); ++iter) {
+        const QPropertyPlanEntry *entry = plan->writableEntry(iter.key().toString());
+        if (!entry)
+            continue;
+
+        const QCborValue value = iter.value();
+        if (entry->pointerToQObject && value.isMap()) {
+            QObject *child = entry->meta.read(object).value<QObject*>();
+            if (child)
+                qcbormap2qobject(value.toMap(), child);
+        } else {
+            writeVariantProperty(object, entry, value.toVariant());
         }
     }
 }
 
+/**
+* This method writes a QObject instance as CBOR into @p device. The
+* document starts with the self-describe tag (55799), which load() uses to
+* tell CBOR from JSON. QCborStreamWriter does not report device errors, so
+* the document is encoded into a buffer and handed to the device in one
+* write.
+*
+* @param device An open, writable device.
+* @param object The QObject instance to be converted.
+* @param ignoredProperties Properties that won't be converted.
+* @return false if the device did not accept the whole document.
+*/
+bool QObjectHelper::writeCborToDevice(QIODevice *device, const QObject *object,
+                                      const QStringList &ignoredProperties)
+{
+    if (!device || !device->isWritable())
+        return false;
+
+    QByteArray data;
+    {
+        QCborStreamWriter writer(&data);
+        writer.append(QCborKnownTags::Signature);
+        QCborValue(qobject2qcbormap(object, ignoredProperties)).toCbor(writer);
+    }
+    const qint64 written = device->write(data);
+    QJSONHELPER_STAT(object ? object->metaObject() : nullptr, BytesWritten, qMax<qint64>(0, written));
+    if (written != data.size()) {
+        qCWarning(lcQJsonHelper) << "CBOR write error:" << device->errorString();
+        return false;
+    }
+    return true;
+}
+
+/**
+* This method parses a CBOR document (optionally starting with the
+* self-describe tag) into a QObject.
+*
+* @param cbor The encoded document.
+* @param object The QObject instance to update.
+*/
+void QObjectHelper::cbor2qobject(const QByteArray &cbor, QObject *object)
+{
+    QJSONHELPER_STAT(object->metaObject(), BytesRead, cbor.size());
+    QCborParserError error;
+    QCborValue value = QCborValue::fromCbor(cbor, &error);
+    if (error.error != QCborError::NoError) {
+        qCWarning(lcQJsonHelper) << error.errorString();
+        return;
+    }
+    if (value.isTag() && value.tag() == QCborKnownTags::Signature)
+        value = value.taggedValue();
+    if (value.isMap())
+        QObjectHelper::qcbormap2qobject(value.toMap(), object);
+}
+
+/**
+* Returns true if @p data looks like a CBOR document: it starts with the
+* self-describe tag written by writeCborToDevice(), or with a CBOR map
+* header (0xa0 - 0xbf), a byte no JSON text can begin with.
+*/
+bool QObjectHelper::isCbor(const QByteArray &data)
+{
+    if (data.isEmpty())
+        return false;
+    const uchar first = uchar(data.at(0));
+    if (first >= 0xa0 && first <= 0xbf)
+        return true;
+    return data.size() >= 3
+            && first == 0xd9 && uchar(data.at(1)) == 0xd9 && uchar(data.at(2)) == 0xf7;
+}
+#endif
+
 
 /**
 * This method converts a json string instance into a QObject
@@ -257,25 +1059,336 @@ void QObjectHelper::qjsonobject2qobject(const QJsonObject& jsonobj, QObject* obj
 */
 void QObjectHelper::json2qobject(const QString &json, QObject *object)
 {
+    QObjectHelper::json2qobject(json.toUtf8(), object);
+}
+
+/**
+* This method parses UTF-8 encoded json into a QObject, without converting
+* it to a QString first.
+*
+* @param json UTF-8 encoded json text.
+* @param object The QObject instance to update.
+*/
+void QObjectHelper::json2qobject(const QByteArray &json, QObject *object)
+{
+    QJSONHELPER_STAT(object->metaObject(), BytesRead, json.size());
     QJsonParseError error;
-    QJsonDocument doc = QJsonDocument::fromJson(json.toStdString().data(), &error);
+    QJsonDocument doc = QJsonDocument::fromJson(json, &error);
     if (error.error == QJsonParseError::NoError){
         QObjectHelper::qjsonobject2qobject(doc.object(), object);
     }else{
-        qDebug() << error.errorString();
+        qCWarning(lcQJsonHelper) << error.errorString();
+    }
+}
+
+/**
+* This method parses @p size bytes of UTF-8 encoded json starting at
+* @p data into a QObject. The bytes are not copied.
+*
+* @param data UTF-8 encoded json text.
+* @param size Length of @p data in bytes.
+* @param object The QObject instance to update.
+*/
+void QObjectHelper::json2qobject(const char *data, int size, QObject *object)
+{
+    QObjectHelper::json2qobject(QByteArray::fromRawData(data, size), object);
+}
+
+/**
+* This method parses NUL-terminated UTF-8 encoded json into a QObject.
+*
+* @param json UTF-8 encoded json text.
+* @param object The QObject instance to update.
+*/
+void QObjectHelper::json2qobject(const char *json, QObject *object)
+{
+    QObjectHelper::json2qobject(QByteArray::fromRawData(json, int(qstrlen(json))), object);
+}
+
+/**
+* This method assigns the listed top level members of @p json to a QObject.
+* The values of all other members are skipped by a structural scanner
+* (see QJsonProjection) instead of being parsed, so the cost follows the
+* size of the selected values rather than of the document.
+*
+* @param json UTF-8 encoded json text.
+* @param object The QObject instance to update.
+* @param properties Keys to load; empty means every writable property of
+* @p object.
+*/
+void QObjectHelper::json2qobjectProjected(const QByteArray &json, QObject *object,
+                                          const QStringList &properties)
+{
+    QJSONHELPER_STAT(object->metaObject(), BytesRead, json.size());
+    QStringList keys = properties;
+    if (keys.isEmpty())
+        keys = QPropertyPlan::get(object)->writableIndex.keys();
+
+    QString error;
+    const QJsonObject selected = QJsonProjection::extract(json, keys, &error);
+    if (!error.isEmpty()) {
+        qCWarning(lcQJsonHelper) << error;
+        return;
     }
+    QObjectHelper::qjsonobject2qobject(selected, object);
 }
 
+/**
+* This method writes a QObject instance as json to @p fpath. The file is
+* replaced atomically (QSaveFile): readers never see a partial document and
+* a failed write leaves the previous content in place.
+*
+* @param fpath Destination file.
+* @param object The QObject instance to be converted.
+*/
 void QObjectHelper::writeToFile(const QString &fpath, QObject *object)
 {
-//    qDebug() << object;
-    QString json = QObjectHelper::qobject2json(object);
-//    qDebug() << json;
-    QFile f(fpath);
-    if (f.open(QIODevice::ReadWrite)){
-        f.write(json.toUtf8());
+    QSaveFile f(fpath);
+    if (f.open(QIODevice::WriteOnly)){
+        if (QObjectHelper::writeToDevice(&f, object))
+            f.commit();
+        else
+            f.cancelWriting();
     }else{
-        qDebug() << "File[" << fpath << "]open error: " << f.errorString();
+        qCWarning(lcQJsonHelper) << "File[" << fpath << "]open error: " << f.errorString();
+    }
+}
+
+namespace {
+
+// Below this many objects the thread pool costs more than it saves.
+const int MinParallelBatch = 16;
+
+struct BatchItem {
+    QObjectRecordSink record;   // taken on the calling thread
+    QJsonObject json;
+    QByteArray bytes;
+};
+
+void encodeBatchJson(BatchItem &item)
+{
+    QJsonObjectSink sink;
+    item.record.replay(sink);
+    item.json = sink.result();
+    item.record.clear();
+}
+
+void encodeBatchBytes(BatchItem &item)
+{
+    QJsonStreamWriter writer(&item.bytes);
+    QJsonWriterSink sink(writer);
+    item.record.replay(sink);
+    item.record.clear();
+}
+
+// One element of a json array, parsed on the thread pool.
+struct ParseItem {
+    QByteArray text;        // raw slice of the input, not copied
+    QJsonObject json;
+    bool object = false;
+    bool ok = true;
+};
+
+void parseBatchItem(ParseItem &item)
+{
+    QJsonParseError error;
+    const QJsonDocument doc = QJsonDocument::fromJson(item.text, &error);
+    if (error.error != QJsonParseError::NoError) {
+        qCWarning(lcQJsonHelper) << error.errorString();
+        item.ok = false;
+        return;
+    }
+    item.json = doc.object();
+}
+
+template <typename Item, typename Function>
+void runBatch(QVector<Item> &items, Function function)
+{
+    if (items.size() < MinParallelBatch || QThreadPool::globalInstance()->maxThreadCount() < 2) {
+        for (Item &item : items)
+            function(item);
+    } else {
+        QtConcurrent::blockingMap(items, function);
+    }
+}
+
+QVector<BatchItem> recordBatch(const QList<const QObject *> &objects,
+                               const QStringList &ignoredProperties)
+{
+    QVector<BatchItem> items(objects.size());
+    for (int i = 0; i < objects.size(); ++i)
+        QObjectHelper::visit(objects.at(i), items[i].record, ignoredProperties);
+    return items;
+}
+
+inline int skipSpace(const char *data, int size, int pos)
+{
+    while (pos < size && (data[pos] == ' ' || data[pos] == '\n' || data[pos] == '\r' || data[pos] == '\t'))
+        ++pos;
+    return pos;
+}
+
+// Cuts the top level array of @p json into its first @p limit elements
+// with QJsonProjection's structural scanner. Returns false if @p json is
+// not an array or the scanner hits malformed input.
+bool splitArray(const QByteArray &json, int limit, QVector<ParseItem> *items)
+{
+    const char *data = json.constData();
+    const int size = json.size();
+    int pos = skipSpace(data, size, json.startsWith("\xef\xbb\xbf") ? 3 : 0);
+    if (pos >= size || data[pos] != '[')
+        return false;
+    pos = skipSpace(data, size, pos + 1);
+    if (pos < size && data[pos] == ']')
+        return true;
+
+    while (items->size() < limit) {
+        pos = skipSpace(data, size, pos);
+        const int end = QJsonProjection::skipValue(data, size, pos);
+        if (end < 0)
+            return false;
+        ParseItem item;
+        item.object = data[pos] == '{';
+        if (item.object)
+            item.text = QByteArray::fromRawData(data + pos, end - pos);
+        items->append(item);
+
+        pos = skipSpace(data, size, end);
+        if (pos >= size)
+            return false;
+        if (data[pos] == ']')
+            break;
+        if (data[pos] != ',')
+            return false;
+        ++pos;
+    }
+    return true;
+}
+
+} // namespace
+
+/**
+* This method converts many QObject instances into one QJsonArray, in the
+* order of @p objects. The result is the same as calling
+* qobject2qjsonobject() for each object.
+*
+* Properties are read on the calling thread (QObjects may only be touched
+* from the thread they live in) and recorded as they are (see
+* QObjectRecordSink), which only copies implicitly shared values. The
+* conversion to JSON, including Base64 and nested objects, is spread over
+* QThreadPool::globalInstance().
+*
+* @param objects The QObject instances to be converted.
+* @param ignoredProperties Properties that won't be converted.
+*/
+QJsonArray QObjectHelper::serializeBatch(const QList<const QObject *> &objects,
+                                         const QStringList &ignoredProperties)
+{
+    QVector<BatchItem> items = recordBatch(objects, ignoredProperties);
+    runBatch(items, encodeBatchJson);
+
+    QJsonArray result;
+    for (const BatchItem &item : items)
+        result.append(item.json);
+    return result;
+}
+
+/**
+* This method works like serializeBatch() but returns the compact UTF-8
+* json text of the array. Each object is encoded into its own buffer on
+* the thread pool; the buffers are then joined in order.
+*
+* @param objects The QObject instances to be converted.
+* @param ignoredProperties Properties that won't be converted.
+*/
+QByteArray QObjectHelper::serializeBatchToJson(const QList<const QObject *> &objects,
+                                               const QStringList &ignoredProperties)
+{
+    QVector<BatchItem> items = recordBatch(objects, ignoredProperties);
+    runBatch(items, encodeBatchBytes);
+
+    int size = 2;
+    for (const BatchItem &item : items)
+        size += item.bytes.size() + 1;
+
+    QByteArray result;
+    result.reserve(size);
+    result.append('[');
+    for (int i = 0; i < items.size(); ++i) {
+        if (i > 0)
+            result.append(',');
+        result.append(items.at(i).bytes);
+    }
+    result.append(']');
+    return result;
+}
+
+/**
+* This method assigns the i-th object of @p array to the i-th QObject of
+* @p objects with qjsonobject2qobject(). The json is already parsed and
+* properties can only be written on the objects' thread, so this runs
+* on the calling thread.
+*
+* @param array Json objects to assign; non-object entries are skipped.
+* @param objects The QObject instances to update.
+* @return The number of objects that were updated.
+*/
+int QObjectHelper::deserializeBatch(const QJsonArray &array, const QList<QObject *> &objects)
+{
+    const int count = qMin(array.size(), objects.size());
+    int updated = 0;
+    for (int i = 0; i < count; ++i) {
+        if (!objects.at(i) || !array.at(i).isObject())
+            continue;
+        qjsonobject2qobject(array.at(i).toObject(), objects.at(i));
+        ++updated;
+    }
+    return updated;
+}
+
+/**
+* This method assigns the elements of a UTF-8 encoded json array to
+* @p objects like deserializeBatch(const QJsonArray&, ...). The array is
+* cut into its elements with a structural scanner (see QJsonProjection)
+* and the elements are parsed in parallel on the thread pool; properties
+* are then written on the calling thread. Elements past the end of
+* @p objects are not parsed.
+*
+* @param json UTF-8 encoded json array.
+* @param objects The QObject instances to update.
+* @return The number of objects that were updated, or -1 on a parse error
+* (no object is updated then).
+*/
+int QObjectHelper::deserializeBatch(const QByteArray &json, const QList<QObject *> &objects)
+{
+    QVector<ParseItem> items;
+    if (!splitArray(json, objects.size(), &items)) {
+        qCWarning(lcQJsonHelper) << "deserializeBatch: malformed json array";
+        return -1;
+    }
+
+    QVector<ParseItem> parsed;
+    parsed.reserve(items.size());
+    for (const ParseItem &item : items) {
+        if (item.object)
+            parsed.append(item);
+    }
+    runBatch(parsed, parseBatchItem);
+    for (const ParseItem &item : parsed) {
+        if (!item.ok)
+            return -1;
+    }
+
+    int updated = 0;
+    int next = 0;
+    for (int i = 0; i < items.size(); ++i) {
+        if (!items.at(i).object)
+            continue;
+        const ParseItem &item = parsed.at(next++);
+        if (!objects.at(i))
+            continue;
+        qjsonobject2qobject(item.json, objects.at(i));
+        ++updated;
     }
-    f.close();
+    return updated;
 }
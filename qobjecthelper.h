@@ -1,20 +1,33 @@
 ﻿#ifndef QOBJECTHELPER_H
 #define QOBJECTHELPER_H
 
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
 #include <QtCore/QLatin1String>
+#include <QtCore/QList>
+#include <QtCore/QMetaType>
 #include <QtCore/QStringList>
 #include <QtCore/QVariantMap>
 
 QT_BEGIN_NAMESPACE
+class QCborMap;
+class QIODevice;
 class QObject;
 QT_END_NAMESPACE
 
+class QJsonStreamWriter;
+class QObjectSink;
+
 class QObjectHelper {
     public:
       QObjectHelper();
       ~QObjectHelper();
 
 
+    static void visit(const QObject* object, QObjectSink& sink,
+                                  const QStringList& ignoredProperties = QStringList(QStringLiteral("objectName")));
+
     static QJsonObject qobject2qjsonobject( const QObject* object,
                                   const QStringList& ignoredProperties = QStringList(QString(QLatin1String("objectName"))));
 
@@ -25,12 +38,88 @@ class QObjectHelper {
                                   const QStringList& ignoredProperties = QStringList(QString(QLatin1String("objectName"))));
 
 
+    static void writeQObject(QJsonStreamWriter& writer, const QObject* object,
+                                  const QStringList& ignoredProperties = QStringList(QStringLiteral("objectName")));
+
+    static void writeProperties(QJsonStreamWriter& writer, const QObject* object,
+                                  const QStringList& properties);
+
+    static bool writeToDevice(QIODevice* device, const QObject* object,
+                                  QJsonDocument::JsonFormat format = QJsonDocument::Compact,
+                                  const QStringList& ignoredProperties = QStringList(QStringLiteral("objectName")));
+
+
     static void qjsonobject2qobject(const QJsonObject &jsonobj, QObject* object);
 
+    static void qjsonobject2qobject(const QJsonObject &jsonobj, const QJsonObject &previous, QObject* object);
+
+    static QJsonArray diff(const QObject* from, const QObject* to,
+                                  const QStringList& ignoredProperties = QStringList(QStringLiteral("objectName")));
+
+    static QJsonArray diff(const QJsonObject& from, const QJsonObject& to);
+
+    static bool applyPatch(QObject* object, const QJsonArray& patch);
+
+    // Lets applyPatch() add and remove elements of QList<T*> properties by
+    // registering the QList<QObject*> -> QList<T*> conversion their write
+    // goes through. T also needs a Q_INVOKABLE T(QObject* parent).
+    template <typename T>
+    static void registerObjectList() {
+        if (QMetaType::hasRegisteredConverterFunction<QList<QObject*>, QList<T*>>())
+            return;
+        QMetaType::registerConverter<QList<QObject*>, QList<T*>>([](const QList<QObject*> &objs) {
+            QList<T*> list;
+            list.reserve(objs.size());
+            for (QObject *obj : objs)
+                list.append(qobject_cast<T*>(obj));
+            return list;
+        });
+    }
+
+    static void qjsonvalue2qobject(const QJsonValue &jsonval, QObject* object);
+
+    static void qvariantmap2qobject(const QVariantMap &map, QObject* object);
+
     static void json2qobject(const QString& json, QObject* object);
 
+    static void json2qobject(const QByteArray& json, QObject* object);
+
+    static void json2qobject(const char* data, int size, QObject* object);
+
+    // NUL-terminated UTF-8; keeps json2qobject("{...}", object) unambiguous.
+    static void json2qobject(const char* json, QObject* object);
+
+    // Assigns only the listed top level members (by default the object's
+    // writable properties); other values are skipped unparsed.
+    static void json2qobjectProjected(const QByteArray& json, QObject* object,
+                                      const QStringList& properties = QStringList());
+
     static void writeToFile(const QString& fpath, QObject* object);
 
+    static QJsonArray serializeBatch(const QList<const QObject*>& objects,
+                                  const QStringList& ignoredProperties = QStringList(QStringLiteral("objectName")));
+
+    static QByteArray serializeBatchToJson(const QList<const QObject*>& objects,
+                                  const QStringList& ignoredProperties = QStringList(QStringLiteral("objectName")));
+
+    static int deserializeBatch(const QJsonArray& array, const QList<QObject*>& objects);
+
+    static int deserializeBatch(const QByteArray& json, const QList<QObject*>& objects);
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+    static QCborMap qobject2qcbormap(const QObject* object,
+                                  const QStringList& ignoredProperties = QStringList(QStringLiteral("objectName")));
+
+    static void qcbormap2qobject(const QCborMap& map, QObject* object);
+
+    static bool writeCborToDevice(QIODevice* device, const QObject* object,
+                                  const QStringList& ignoredProperties = QStringList(QStringLiteral("objectName")));
+
+    static void cbor2qobject(const QByteArray& cbor, QObject* object);
+
+    static bool isCbor(const QByteArray& data);
+#endif
+
     private:
       Q_DISABLE_COPY(QObjectHelper)
       class QObjectHelperPrivate;
@@ -0,0 +1,159 @@
+﻿#ifndef QOBJECTHELPER_P_H
+#define QOBJECTHELPER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the QJsonHelper API. It exists purely as an
+// implementation detail of the QJsonHelper sources and may change from version
+// to version without notice.
+//
+
+#include <QtCore/QBitArray>
+#include <QtCore/QDebug>
+#include <QtCore/QFile>
+#include <QtCore/QHash>
+#include <QtCore/QJsonObject>
+#include <QtCore/QMetaObject>
+#include <QtCore/QMetaProperty>
+#include <QtCore/QReadWriteLock>
+#include <QtCore/QStringList>
+#include <QtCore/QVector>
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+#include <QtCore/QCborMap>
+#endif
+
+#include <limits>
+
+#include "qjsonconverter.h"
+#include "qjsonfield.h"
+#include "qjsonstats.h"
+
+/**
+* @brief One property of a QMetaObject, resolved once and reused by every
+* conversion that touches objects of that class.
+*/
+struct QPropertyPlanEntry {
+    QMetaProperty meta;
+    QString key;            // JSON / QVariantMap key (the property name)
+    QVariant::Type type;    // QMetaProperty::type()
+    int typeId;             // QMetaProperty::userType()
+    bool readable;
+    bool writable;
+    bool pointerToQObject;  // QObject* or a registered QObject subclass pointer
+    const QJsonFieldDescriptor *field;  // typed accessors (Q_JSON_FIELDS), or nullptr
+    const QJsonConverterSlot *converter;  // registry slot of typeId, never nullptr
+};
+
+/**
+* @brief Lazily built, per-QMetaObject property plan.
+*
+* Plans are created on first use, shared by all threads and live until the
+* program exits (meta objects are static data, so are their plans).
+*/
+class QPropertyPlan {
+public:
+    // The plan of the object's most derived class. The object is only used
+    // to pick up the class's typed field table the first time.
+    static const QPropertyPlan *get(const QObject *object);
+
+    // Bit i is set when entries[i] is listed in @p ignoredProperties.
+    // The mask is computed once per distinct ignore list.
+    QBitArray ignoreMask(const QStringList &ignoredProperties) const;
+
+    const QPropertyPlanEntry *writableEntry(const QString &key) const {
+        const int i = writableIndex.value(key, -1);
+        return i < 0 ? nullptr : &entries.at(i);
+    }
+
+    QVector<QPropertyPlanEntry> entries;    // all properties, metaobject order
+    QVector<int> readableIndex;             // readable entries, metaobject order
+    QHash<QString, int> writableIndex;      // key -> index into entries
+
+private:
+    QPropertyPlan(const QMetaObject *metaobject, const QJsonFieldTable *fields);
+    Q_DISABLE_COPY(QPropertyPlan)
+
+    mutable QReadWriteLock maskLock_;
+    mutable QHash<QString, QBitArray> masks_;
+};
+
+/**
+* @brief Values of the properties QObjectHelper's deserializers write to one
+* object while a QJsonHelper transaction is open on the calling thread.
+*
+* QJsonHelper::beginUpdate() creates the log. The deserializers call
+* record() right before they write or reset a property, which keeps the
+* value the property had before its first write; endUpdate() compares only
+* those properties. Logs of different objects may be open at once.
+*/
+class QPropertyWriteLog {
+public:
+    explicit QPropertyWriteLog(QObject *object);
+    ~QPropertyWriteLog();
+
+    // Notes that @p entry of @p object is about to be written.
+    static void record(QObject *object, const QPropertyPlanEntry &entry);
+
+    // entry -> value before its first write
+    const QHash<const QPropertyPlanEntry *, QVariant> &values() const {
+        return values_;
+    }
+
+private:
+    Q_DISABLE_COPY(QPropertyWriteLog)
+
+    QObject *object_;
+    QPropertyWriteLog *next_;   // other open logs of this thread
+    QHash<const QPropertyPlanEntry *, QVariant> values_;
+};
+
+/**
+* Opens @p fpath and hands its whole content to @p parse as one QByteArray.
+* Regular files are memory mapped and passed through QByteArray::fromRawData,
+* so the bytes are never copied to the heap; the array is only valid during
+* the call. Other devices (and empty files) fall back to readAll().
+*/
+template <typename Parse>
+bool qReadMappedFile(const QString &fpath, Parse parse)
+{
+    QFile f(fpath);
+    if (!f.open(QIODevice::ReadOnly)) {
+        qCWarning(lcQJsonHelper) << "File[" << fpath << "]open error: " << f.errorString();
+        return false;
+    }
+
+    const qint64 size = f.size();
+    uchar *data = nullptr;
+    if (size > 0 && size <= std::numeric_limits<int>::max())
+        data = f.map(0, size);
+
+    if (data) {
+        parse(QByteArray::fromRawData(reinterpret_cast<const char *>(data), int(size)));
+        f.unmap(data);
+    } else {
+        parse(f.readAll());
+    }
+    f.close();
+    return true;
+}
+
+/**
+* @brief A file read and parsed off the object's thread, applied later on
+* the object's thread (QJsonHelper::loadAsync(), QJsonBulkLoader).
+*/
+struct QParsedDocument {
+    bool ok = false;
+    QString error;          // set when ok is false
+    QJsonObject json;
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+    bool cbor = false;
+    QCborMap cborMap;
+#endif
+};
+
+// Reads @p fpath (JSON or CBOR, detected by content); thread safe.
+QParsedDocument qParseDocument(const QString &fpath);
+
+#endif // QOBJECTHELPER_P_H
@@ -0,0 +1,71 @@
+﻿#include "qobjectlistwatcher.h"
+
+#include <QtCore/QMetaMethod>
+#include <QtCore/QMetaProperty>
+
+QObjectListWatcher::QObjectListWatcher(QObject *parent)
+  : QObject(parent)
+  , generation_(0)
+  , hasJson_(false)
+{
+}
+
+/**
+* This method connects to the NOTIFY signals of @p item's readable
+* properties.
+*
+* @param item A list item.
+*/
+void QObjectListWatcher::watch(QObject *item)
+{
+    if (!item)
+        return;
+    const QMetaMethod slot = staticMetaObject.method(
+                staticMetaObject.indexOfSlot("onPropertyNotify()"));
+    const QMetaObject *metaobject = item->metaObject();
+    for (int i = 0; i < metaobject->propertyCount(); ++i) {
+        const QMetaProperty metaproperty = metaobject->property(i);
+        if (metaproperty.isReadable() && metaproperty.hasNotifySignal())
+            connect(item, metaproperty.notifySignal(), this, slot, Qt::UniqueConnection);
+    }
+}
+
+void QObjectListWatcher::unwatch(QObject *item)
+{
+    if (!item)
+        return;
+    disconnect(item, nullptr, this, nullptr);
+    dirty_.remove(item);
+}
+
+void QObjectListWatcher::touch()
+{
+    ++generation_;
+    dropJson();
+}
+
+QSet<QObject *> QObjectListWatcher::takeDirty()
+{
+    QSet<QObject *> dirty;
+    dirty.swap(dirty_);
+    return dirty;
+}
+
+void QObjectListWatcher::setJson(const QJsonArray &json)
+{
+    json_ = json;
+    hasJson_ = true;
+}
+
+void QObjectListWatcher::dropJson()
+{
+    json_ = QJsonArray();
+    hasJson_ = false;
+}
+
+void QObjectListWatcher::onPropertyNotify()
+{
+    ++generation_;
+    dirty_.insert(sender());
+    dropJson();
+}
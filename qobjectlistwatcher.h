@@ -0,0 +1,55 @@
+﻿#ifndef QOBJECTLISTWATCHER_H
+#define QOBJECTLISTWATCHER_H
+
+#include <QtCore/QJsonArray>
+#include <QtCore/QObject>
+#include <QtCore/QSet>
+
+/**
+* @brief Generation counter of a list of QObjects.
+*
+* watch() connects to the NOTIFY signals of an item's readable properties.
+* Every notification increments generation() and marks the sender dirty;
+* structural changes of the list are reported with touch(). Caches derived
+* from the list remember the generation they were built at and compare
+* numbers instead of contents (see Q_PROPERTY_QMLLIST_OBJECTS).
+*
+* The watcher can also hold the list's JSON form. Every change drops it, so
+* the array is only resident between a read and the next edit.
+*/
+class QObjectListWatcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit QObjectListWatcher(QObject *parent = nullptr);
+
+    void watch(QObject *item);
+    void unwatch(QObject *item);
+
+    quint64 generation() const { return generation_; }
+
+    // Counts a change the items did not notify, e.g. an insertion.
+    void touch();
+
+    // Items that emitted a NOTIFY signal since the last call.
+    QSet<QObject *> takeDirty();
+
+    // JSON cached by setJson(); hasJson() is false once the list changed.
+    bool hasJson() const { return hasJson_; }
+    QJsonArray json() const { return json_; }
+    void setJson(const QJsonArray &json);
+
+private slots:
+    void onPropertyNotify();
+
+private:
+    void dropJson();
+
+    quint64 generation_;
+    QSet<QObject *> dirty_;
+    QJsonArray json_;
+    bool hasJson_;
+};
+
+#endif // QOBJECTLISTWATCHER_H
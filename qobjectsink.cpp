@@ -0,0 +1,231 @@
+﻿#include "qobjectsink.h"
+
+#include "qjsonbase64.h"
+#include "qjsonblobstore.h"
+#include "qjsonstreamwriter.h"
+
+namespace {
+
+// Reference to a sidecar file when a QJsonBlobStore is active and the
+// value is large enough, otherwise null.
+inline QJsonObject blobReference(const QByteArray &value)
+{
+    QJsonBlobStore *store = QJsonBlobStore::current();
+    if (!store || value.size() < store->threshold())
+        return QJsonObject();
+    return store->store(value);
+}
+
+} // namespace
+
+void QJsonObjectSink::value(const QVariant &value)
+{
+    switch (value.userType()) {
+    case QMetaType::QJsonValue:
+        add(value.value<QJsonValue>());
+        break;
+    case QMetaType::QJsonObject:
+        add(value.value<QJsonObject>());
+        break;
+    case QMetaType::QJsonArray:
+        add(value.value<QJsonArray>());
+        break;
+    default:
+        add(QJsonValue::fromVariant(value));
+        break;
+    }
+}
+
+void QJsonObjectSink::bytes(const QByteArray &value)
+{
+    const QJsonObject reference = blobReference(value);
+    if (!reference.isEmpty())
+        add(reference);
+    else
+        add(QJsonBase64::encodeToString(value));
+}
+
+void QVariantMapSink::bytes(const QByteArray &value)
+{
+    const QJsonObject reference = blobReference(value);
+    if (!reference.isEmpty())
+        add(reference.toVariantMap());
+    else
+        add(QJsonBase64::encodeToString(value));
+}
+
+void QJsonWriterSink::beginObject()
+{
+    writer_.beginObject();
+}
+
+void QJsonWriterSink::endObject()
+{
+    writer_.endObject();
+}
+
+void QJsonWriterSink::beginArray()
+{
+    writer_.beginArray();
+}
+
+void QJsonWriterSink::endArray()
+{
+    writer_.endArray();
+}
+
+void QJsonWriterSink::key(const QString &name)
+{
+    writer_.writeKey(name);
+}
+
+void QJsonWriterSink::nullValue()
+{
+    writer_.writeNull();
+}
+
+void QJsonWriterSink::value(const QVariant &value)
+{
+    writer_.writeVariant(value);
+}
+
+void QJsonWriterSink::jsonValue(const QJsonValue &value)
+{
+    writer_.writeValue(value);
+}
+
+void QJsonWriterSink::bytes(const QByteArray &value)
+{
+    const QJsonObject reference = blobReference(value);
+    if (!reference.isEmpty())
+        writer_.writeValue(reference);
+    else
+        writer_.writeBase64(value);
+}
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+void QCborMapSink::value(const QVariant &value)
+{
+    switch (value.userType()) {
+    case QMetaType::QJsonValue:
+        add(QCborValue::fromJsonValue(value.value<QJsonValue>()));
+        break;
+    case QMetaType::QJsonObject:
+        add(QCborMap::fromJsonObject(value.value<QJsonObject>()));
+        break;
+    case QMetaType::QJsonArray:
+        add(QCborArray::fromJsonArray(value.value<QJsonArray>()));
+        break;
+    default:
+        add(QCborValue::fromVariant(value));
+        break;
+    }
+}
+#endif
+
+void QObjectRecordSink::bytes(const QByteArray &value)
+{
+    const QJsonObject reference = blobReference(value);
+    if (!reference.isEmpty())
+        append(JsonValue, QVariant(QJsonValue(reference)));
+    else
+        append(Bytes, value);
+}
+
+void QObjectRecordSink::replay(QObjectSink &sink) const
+{
+    for (const Event &event : events_) {
+        switch (event.kind) {
+        case BeginObject:
+            sink.beginObject();
+            break;
+        case EndObject:
+            sink.endObject();
+            break;
+        case BeginArray:
+            sink.beginArray();
+            break;
+        case EndArray:
+            sink.endArray();
+            break;
+        case Key:
+            sink.key(event.payload.toString());
+            break;
+        case Null:
+            sink.nullValue();
+            break;
+        case Value:
+            sink.value(event.payload);
+            break;
+        case JsonValue:
+            sink.jsonValue(event.payload.toJsonValue());
+            break;
+        case Bytes:
+            sink.bytes(event.payload.toByteArray());
+            break;
+        }
+    }
+}
+
+void QObjectSinkGroup::beginObject()
+{
+    for (QObjectSink *sink : sinks_)
+        sink->beginObject();
+}
+
+void QObjectSinkGroup::endObject()
+{
+    for (QObjectSink *sink : sinks_)
+        sink->endObject();
+}
+
+void QObjectSinkGroup::beginArray()
+{
+    for (QObjectSink *sink : sinks_)
+        sink->beginArray();
+}
+
+void QObjectSinkGroup::endArray()
+{
+    for (QObjectSink *sink : sinks_)
+        sink->endArray();
+}
+
+void QObjectSinkGroup::key(const QString &name)
+{
+    for (QObjectSink *sink : sinks_)
+        sink->key(name);
+}
+
+void QObjectSinkGroup::nullValue()
+{
+    for (QObjectSink *sink : sinks_)
+        sink->nullValue();
+}
+
+void QObjectSinkGroup::value(const QVariant &value)
+{
+    for (QObjectSink *sink : sinks_)
+        sink->value(value);
+}
+
+void QObjectSinkGroup::jsonValue(const QJsonValue &value)
+{
+    for (QObjectSink *sink : sinks_)
+        sink->jsonValue(value);
+}
+
+void QObjectSinkGroup::bytes(const QByteArray &value)
+{
+    for (QObjectSink *sink : sinks_)
+        sink->bytes(value);
+}
+
+bool QObjectSinkGroup::acceptsTypedFields() const
+{
+    for (const QObjectSink *sink : sinks_) {
+        if (!sink->acceptsTypedFields())
+            return false;
+    }
+    return true;
+}
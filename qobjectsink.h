@@ -0,0 +1,248 @@
+﻿#ifndef QOBJECTSINK_H
+#define QOBJECTSINK_H
+
+#include <QtCore/QByteArray>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonObject>
+#include <QtCore/QJsonValue>
+#include <QtCore/QList>
+#include <QtCore/QVariant>
+#include <QtCore/QVector>
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+#include <QtCore/QCborArray>
+#include <QtCore/QCborMap>
+#include <QtCore/QCborValue>
+#endif
+
+class QJsonStreamWriter;
+
+/**
+* @brief Receives the properties of a QObject from QObjectHelper::visit().
+*
+* visit() walks the object once and reports its structure through these
+* calls: nested QObject* properties and QList<QObject*> properties arrive
+* as nested objects and arrays, QByteArray values through bytes(), values
+* of typed fields (see qjsonfield.h) through jsonValue() and everything
+* else through value(). Sinks decide how each kind is represented, so the
+* traversal rules are the same for every output format.
+*
+* The json and QVariantMap sinks store large byte arrays as sidecar files
+* while a QJsonBlobStore::Scope is active (see qjsonblobstore.h).
+*/
+class QObjectSink {
+public:
+    virtual ~QObjectSink() {}
+
+    virtual void beginObject() = 0;
+    virtual void endObject() = 0;
+    virtual void beginArray() = 0;
+    virtual void endArray() = 0;
+
+    // Name of the next value inside an object.
+    virtual void key(const QString &name) = 0;
+
+    virtual void nullValue() = 0;
+    virtual void value(const QVariant &value) = 0;
+    virtual void jsonValue(const QJsonValue &value) = 0;
+    virtual void bytes(const QByteArray &value) = 0;
+
+    // Sinks returning false get typed fields as plain property values
+    // through value(), keeping their native (e.g. integer) type.
+    virtual bool acceptsTypedFields() const { return true; }
+};
+
+/**
+* @brief Base of the sinks that build an in-memory tree (QJsonObject,
+* QVariantMap, QCborMap). Containers are filled in place while they are
+* open and handed to their parent when they are closed.
+*/
+template <typename Value, typename Map, typename List>
+class QObjectTreeSink : public QObjectSink {
+public:
+    void beginObject() override { push(false); }
+    void endObject() override { pop(); }
+    void beginArray() override { push(true); }
+    void endArray() override { pop(); }
+    void key(const QString &name) override { key_ = name; }
+
+protected:
+    void add(const Value &value) {
+        if (frames_.isEmpty()) {
+            result_ = value;
+            return;
+        }
+        Frame &frame = frames_.last();
+        if (frame.array)
+            frame.list.append(value);
+        else
+            frame.map.insert(key_, value);
+    }
+
+    Value result_;
+
+private:
+    struct Frame {
+        Map map;
+        List list;
+        bool array;
+        QString key;    // key of this container in its parent
+    };
+
+    void push(bool array) {
+        Frame frame;
+        frame.array = array;
+        frame.key = key_;
+        frames_.append(frame);
+    }
+    void pop() {
+        const Frame frame = frames_.takeLast();
+        key_ = frame.key;
+        if (frame.array)
+            add(Value(frame.list));
+        else
+            add(Value(frame.map));
+    }
+
+    QVector<Frame> frames_;
+    QString key_;
+};
+
+/**
+* @brief Builds a QJsonObject; QByteArray values become Base64 strings.
+*/
+class QJsonObjectSink : public QObjectTreeSink<QJsonValue, QJsonObject, QJsonArray> {
+public:
+    QJsonObject result() const { return result_.toObject(); }
+
+    void nullValue() override { add(QJsonValue()); }
+    void value(const QVariant &value) override;
+    void jsonValue(const QJsonValue &value) override { add(value); }
+    void bytes(const QByteArray &value) override;
+};
+
+/**
+* @brief Builds a QVariantMap (e.g. for QML); QByteArray values become
+* Base64 strings, other values keep their QVariant type.
+*/
+class QVariantMapSink : public QObjectTreeSink<QVariant, QVariantMap, QVariantList> {
+public:
+    QVariantMap result() const { return result_.toMap(); }
+
+    void nullValue() override { add(QVariant()); }
+    void value(const QVariant &value) override { add(value); }
+    void jsonValue(const QJsonValue &value) override { add(value.toVariant()); }
+    void bytes(const QByteArray &value) override;
+    bool acceptsTypedFields() const override { return false; }
+};
+
+/**
+* @brief Forwards to a QJsonStreamWriter; QByteArray values are written
+* as Base64 strings.
+*/
+class QJsonWriterSink : public QObjectSink {
+public:
+    explicit QJsonWriterSink(QJsonStreamWriter &writer) : writer_(writer) {}
+
+    void beginObject() override;
+    void endObject() override;
+    void beginArray() override;
+    void endArray() override;
+    void key(const QString &name) override;
+    void nullValue() override;
+    void value(const QVariant &value) override;
+    void jsonValue(const QJsonValue &value) override;
+    void bytes(const QByteArray &value) override;
+
+private:
+    QJsonStreamWriter &writer_;
+};
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+/**
+* @brief Builds a QCborMap; QByteArray values are stored as CBOR byte
+* strings and integers keep their integer encoding.
+*/
+class QCborMapSink : public QObjectTreeSink<QCborValue, QCborMap, QCborArray> {
+public:
+    QCborMap result() const { return result_.toMap(); }
+
+    void nullValue() override { add(QCborValue(QCborValue::Null)); }
+    void value(const QVariant &value) override;
+    void jsonValue(const QJsonValue &value) override { add(QCborValue::fromJsonValue(value)); }
+    void bytes(const QByteArray &value) override { add(QCborValue(value)); }
+    bool acceptsTypedFields() const override { return false; }
+};
+#endif
+
+/**
+* @brief Records a traversal so it can be replayed into another sink later,
+* possibly on another thread.
+*
+* Recording only copies the reported values (implicitly shared), so the
+* walk over the QObject stays cheap; the conversion work (Base64, number
+* formatting, building containers) happens in replay(). Byte arrays that
+* go to the active QJsonBlobStore are stored while recording, on the
+* recording thread.
+*/
+class QObjectRecordSink : public QObjectSink {
+public:
+    void beginObject() override { append(BeginObject); }
+    void endObject() override { append(EndObject); }
+    void beginArray() override { append(BeginArray); }
+    void endArray() override { append(EndArray); }
+    void key(const QString &name) override { append(Key, name); }
+    void nullValue() override { append(Null); }
+    void value(const QVariant &value) override { append(Value, value); }
+    void jsonValue(const QJsonValue &value) override { append(JsonValue, QVariant(value)); }
+    void bytes(const QByteArray &value) override;
+
+    void replay(QObjectSink &sink) const;
+    void clear() { events_.clear(); }
+
+private:
+    enum Kind { BeginObject, EndObject, BeginArray, EndArray, Key, Null, Value, JsonValue, Bytes };
+    struct Event {
+        Kind kind;
+        QVariant payload;
+    };
+
+    void append(Kind kind, const QVariant &payload = QVariant()) {
+        Event event = { kind, payload };
+        events_.append(event);
+    }
+
+    QVector<Event> events_;
+};
+
+/**
+* @brief Feeds one traversal to several sinks, e.g. a QVariantMap for QML
+* and a writer for disk:
+*
+* \code
+*   QVariantMapSink map;
+*   QJsonStreamWriter writer(&file);
+*   QJsonWriterSink text(writer);
+*   QObjectSinkGroup group({&map, &text});
+*   QObjectHelper::visit(object, group);
+* \endcode
+*/
+class QObjectSinkGroup : public QObjectSink {
+public:
+    explicit QObjectSinkGroup(const QList<QObjectSink *> &sinks) : sinks_(sinks) {}
+
+    void beginObject() override;
+    void endObject() override;
+    void beginArray() override;
+    void endArray() override;
+    void key(const QString &name) override;
+    void nullValue() override;
+    void value(const QVariant &value) override;
+    void jsonValue(const QJsonValue &value) override;
+    void bytes(const QByteArray &value) override;
+    bool acceptsTypedFields() const override;
+
+private:
+    QList<QObjectSink *> sinks_;
+};
+
+#endif // QOBJECTSINK_H
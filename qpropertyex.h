@@ -2,11 +2,285 @@
 #include <QMetaType>
 #include <QQmlProperty>
 #include <QQmlListProperty>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QPointer>
+#include <QTimer>
+#include <QVector>
+#include "qjsonfield.h"
+#include "qjsonstats.h"
+#include "qjsonstreamreader.h"
+#include "qobjecthelper.h"
+#include "qobjectlistwatcher.h"
+#include "qvariantmapcache.h"
+
+#include <cstring>
+#include <iterator>
+#include <list>
+
+/**
+ * @brief QmlListStats
+ * Q_PROPERTY_QMLLIST 对象复用统计（累计值）。
+ * Cumulative object reuse counters of a Q_PROPERTY_QMLLIST.
+ */
+struct QmlListStats {
+    quint64 reused = 0;
+    quint64 created = 0;
+    quint64 destroyed = 0;
+
+    QVariantMap toVariantMap() const {
+        QVariantMap map;
+        map.insert(QStringLiteral("reused"), reused);
+        map.insert(QStringLiteral("created"), created);
+        map.insert(QStringLiteral("destroyed"), destroyed);
+        return map;
+    }
+};
+
+namespace QPropertyEx {
+
+/**
+ * @brief defaultJsonObject
+ * 默认构造的 T 的 JSON（每个类型只计算一次）。
+ * The json of a default constructed T, computed once per type.
+ */
+template <typename T>
+const QJsonObject &defaultJsonObject()
+{
+    static const QJsonObject defaults = []() {
+        T item;
+        return QObjectHelper::qobject2qjsonobject(&item);
+    }();
+    return defaults;
+}
+
+/**
+ * @brief withDefaults
+ * 用默认构造的 T 的值补全 @p json 中缺少的属性，得到的 JSON 与由 @p json 新建对象的结果一致。
+ * Fills the properties missing from @p json with the values of a default constructed T,
+ * giving the json an object freshly created from @p json would have.
+ */
+template <typename T>
+QJsonObject withDefaults(const QJsonObject &json)
+{
+    const QJsonObject &defaults = defaultJsonObject<T>();
+    QJsonObject values = json;  // only detaches if a key is missing
+    for (QJsonObject::const_iterator it = defaults.constBegin(); it != defaults.constEnd(); ++it) {
+        if (!values.contains(it.key()))
+            values.insert(it.key(), it.value());
+    }
+    return values;
+}
+
+/**
+ * @brief equalsWithDefaults
+ * 判断 withDefaults(row) == target，但不复制 row。
+ * Whether withDefaults(row) would equal @p target, without building that copy;
+ * @p defaults is defaultJsonObject<T>() of the row type.
+ */
+inline bool equalsWithDefaults(const QJsonObject &row, const QJsonObject &target,
+                               const QJsonObject &defaults)
+{
+    for (QJsonObject::const_iterator it = row.constBegin(); it != row.constEnd(); ++it) {
+        const QJsonObject::const_iterator t = target.constFind(it.key());
+        if (t == target.constEnd() || t.value() != it.value())
+            return false;
+    }
+    // the other keys of target must be exactly the defaults row leaves out
+    int missing = 0;
+    for (QJsonObject::const_iterator it = defaults.constBegin(); it != defaults.constEnd(); ++it) {
+        if (row.contains(it.key()))
+            continue;
+        const QJsonObject::const_iterator t = target.constFind(it.key());
+        if (t == target.constEnd() || t.value() != it.value())
+            return false;
+        ++missing;
+    }
+    return row.size() + missing == target.size();
+}
+
+/**
+ * @brief LruList
+ * 最近最少使用顺序，touch/remove/takeOldest 均为 O(1)。
+ * Least recently used order with O(1) touch(), remove() and takeOldest().
+ */
+template <typename T>
+class LruList {
+public:
+    int size() const { return positions_.size(); }
+    bool isEmpty() const { return positions_.isEmpty(); }
+
+    void touch(T *item) {
+        const auto it = positions_.constFind(item);
+        if (it == positions_.constEnd()) {
+            order_.push_back(item);
+            positions_.insert(item, std::prev(order_.end()));
+        } else {
+            order_.splice(order_.end(), order_, it.value());
+        }
+    }
+
+    void remove(T *item) {
+        const auto it = positions_.find(item);
+        if (it == positions_.end())
+            return;
+        order_.erase(it.value());
+        positions_.erase(it);
+    }
+
+    T *takeOldest() {
+        T *item = order_.front();
+        order_.pop_front();
+        positions_.remove(item);
+        return item;
+    }
+
+    void clear() {
+        order_.clear();
+        positions_.clear();
+    }
+
+private:
+    std::list<T*> order_;
+    QHash<T*, typename std::list<T*>::iterator> positions_;
+};
+
+/**
+ * @brief syncObjectList
+ * 将 JSON 数组同步到对象列表：按位置（或按 key 属性）复用已有对象，只为长度差创建/销毁对象。
+ * Syncs @p json into @p items. Existing instances are reused positionally, or
+ * matched by the @p key property when it is not empty; objects are only
+ * created or destroyed for the difference.
+ *
+ * 复用的对象与新建对象结果一致：JSON 中缺少的属性恢复为默认构造 TYPE 的值。
+ * A reused item ends up like a freshly created one: properties missing from
+ * its json get the values of a default constructed T.
+ * 复用的对象在 QJsonHelper 事务中更新（见 beginUpdate）。
+ * Reused items are updated inside a QJsonHelper transaction (see beginUpdate()).
+ */
+template <typename T>
+void syncObjectList(QObject *parent, QList<T*> &items, const QJsonArray &json,
+                    const QString &key, QmlListStats &stats)
+{
+    const QList<T*> old = items;
+    QVector<bool> used(old.size(), false);
+
+    QHash<QString, int> oldByKey;
+    const QByteArray keyName = key.toLatin1();
+    if (!key.isEmpty()) {
+        for (int i = 0; i < old.size(); ++i) {
+            const QString k = old.at(i)->property(keyName.constData()).toString();
+            if (!oldByKey.contains(k))
+                oldByKey.insert(k, i);
+        }
+    }
+
+    items.clear();
+    items.reserve(json.size());
+    for (int j = 0; j < json.size(); ++j) {
+        const QJsonObject obj = json.at(j).toObject();
+        int i = -1;
+        if (key.isEmpty()) {
+            if (j < old.size())
+                i = j;
+        } else {
+            i = oldByKey.value(obj.value(key).toVariant().toString(), -1);
+            if (i >= 0 && used.at(i))
+                i = -1;
+        }
+
+        T *item = nullptr;
+        if (i >= 0) {
+            item = old.at(i);
+            used[i] = true;
+            /* 事务内写入：每个变化的属性只通知一次 / one notification per changed property */
+            item->beginUpdate();
+            QObjectHelper::qjsonobject2qobject(withDefaults<T>(obj), item);
+            item->endUpdate();
+            ++stats.reused;
+        } else {
+            item = new T(parent);
+            QObjectHelper::qjsonobject2qobject(obj, item);
+            ++stats.created;
+            QJSONHELPER_STAT(&T::staticMetaObject, ObjectsCreated, 1);
+        }
+        items.append(item);
+    }
+
+    for (int i = 0; i < old.size(); ++i) {
+        if (!used.at(i)) {
+            old.at(i)->deleteLater();
+            ++stats.destroyed;
+            QJSONHELPER_STAT(&T::staticMetaObject, ObjectsDestroyed, 1);
+        }
+    }
+}
+
+/**
+ * @brief variantMapHash
+ * QVariantMap 的内容哈希，用于在比较整张 map 之前快速排除不匹配的项。
+ * Content hash of a QVariantMap, used to rule out items before comparing whole maps.
+ * QVariant 的 == 会在类型之间转换（1 == "1"、true == "true"），因此值先归一化再参与哈希：
+ * 数值、布尔以及可解析为数值或 "true"/"false" 的字符串按 double 取值，其余字符串按文本；
+ * 嵌套 map/list 等只以键参与哈希。
+ * QVariant's == converts between types (1 == "1", true == "true"), so values are
+ * normalised first: numbers, bools and strings that parse as a number or as
+ * "true"/"false" hash by their double value, other strings by text; nested maps,
+ * lists and other types only contribute their key.
+ */
+inline uint variantValueHash(const QVariant &value)
+{
+    double d = 0;
+    switch (value.userType()) {
+    case QMetaType::Bool:
+    case QMetaType::Int:
+    case QMetaType::UInt:
+    case QMetaType::LongLong:
+    case QMetaType::ULongLong:
+    case QMetaType::Float:
+    case QMetaType::Double:
+        d = value.toDouble();
+        break;
+    case QMetaType::QString: {
+        const QString text = value.toString();
+        bool number = false;
+        d = text.toDouble(&number);
+        if (number)
+            break;
+        if (text.compare(QLatin1String("true"), Qt::CaseInsensitive) == 0) {
+            d = 1;
+            break;
+        }
+        if (text.compare(QLatin1String("false"), Qt::CaseInsensitive) == 0)
+            break;
+        return qHash(text);
+    }
+    default:
+        return 0;
+    }
+    d += 0.0;   // folds -0.0 into 0.0
+    quint64 bits;
+    std::memcpy(&bits, &d, sizeof(bits));
+    return qHash(bits);
+}
+
+inline uint variantMapHash(const QVariantMap &map)
+{
+    uint hash = uint(map.size());
+    for (QVariantMap::const_iterator it = map.constBegin(); it != map.constEnd(); ++it)
+        hash = hash * 31 + (qHash(it.key()) ^ variantValueHash(it.value()));
+    return hash;
+}
+
+} // namespace QPropertyEx
 
 /**
  * @brief Q_PROPERTY_AUTO
  * 自动生成带有信号通知的 Qt 属性。
  * Generates a Qt property with a notification signal automatically.
+ * 在声明了 Q_JSON_FIELDS 的类中，该属性会进入类型化字段表（见 qjsonfield.h）。
+ * In a class declaring Q_JSON_FIELDS the property joins the typed field table (see qjsonfield.h).
  * 
  * @param TYPE 属性类型 / Property type
  * @param NAME 属性名称 / Property name
@@ -24,6 +298,7 @@ Q_PROPERTY(TYPE NAME READ NAME WRITE set##NAME NOTIFY NAME##Changed)
         m_##NAME = value;                                                               \
         emit NAME##Changed(m_##NAME);                                                   \
 }                                                                                       \
+    Q_JSON_FIELD(TYPE, NAME)                                                            \
     private:                                                                            \
     TYPE m_##NAME;
 
@@ -73,6 +348,7 @@ Q_PROPERTY(TYPE NAME READ NAME WRITE set##NAME NOTIFY NAME##Changed)
         m_##NAME = value;                                                               \
         emit NAME##Changed(m_##NAME);                                                   \
 }                                                                                       \
+    Q_JSON_FIELD(TYPE, NAME)                                                            \
     private:                                                                            \
     TYPE m_##NAME{DEFAULT_VALUE};
 
@@ -94,6 +370,7 @@ Q_PROPERTY(TYPE NAME READ NAME WRITE set##NAME NOTIFY NAME##Changed)
         m_##NAME = value;                                                               \
         emit NAME##Changed(m_##NAME);                                                   \
 }                                                                                       \
+    Q_JSON_FIELD(TYPE, NAME)                                                            \
     protected:                                                                          \
     TYPE m_##NAME = DEFAULT_VALUE;
 
@@ -109,6 +386,11 @@ Q_PROPERTY(TYPE NAME READ NAME WRITE set##NAME NOTIFY NAME##Changed)
  *    Automatically creates TYPE object and deserializes when NAME is assigned.
  * 3. 访问 getNAME() 时若对象为空则自动 lazy 初始化。
  *    Automatically lazy-initializes the object if it's null when accessing getNAME().
+ * 4. getNAME() 返回缓存的 QVariantMap，仅在子对象发出 NOTIFY 信号或 setNAME() 后重建；
+ *    子对象变化时发出 NAME##Changed()，嵌套的 Q_PROPERTY_QML 逐级向上失效（见 QVariantMapCache）。
+ *    getNAME() returns a cached QVariantMap, rebuilt only after the object emits a NOTIFY
+ *    signal or setNAME() replaces it. Object changes emit NAME##Changed(), so nested
+ *    Q_PROPERTY_QML levels invalidate upward (see QVariantMapCache).
  */
 #define Q_PROPERTY_QML(TYPE, NAME)                                                          \
     Q_PROPERTY(QVariantMap NAME READ get##NAME WRITE set##NAME NOTIFY NAME##Changed)        \
@@ -117,22 +399,33 @@ Q_PROPERTY(TYPE NAME READ NAME WRITE set##NAME NOTIFY NAME##Changed)
     QVariantMap get##NAME() {                                                               \
         if (m_##NAME == nullptr) {                                                          \
             m_##NAME = new TYPE(this);                                                      \
+            NAME##Watch();                                                                  \
         }                                                                                   \
-        return QObjectHelper::qobject2variantmap(m_##NAME);                                 \
+        return m_##NAME##Cache.map();                                                       \
     }                                                                                       \
     void set##NAME(const QVariantMap& value) {                                              \
         if (m_##NAME) {                                                                     \
             m_##NAME->deleteLater();                                                        \
             m_##NAME = nullptr;                                                             \
         }                                                                                   \
+        m_##NAME##Cache.watch(nullptr);                                                     \
         if (!value.isEmpty()) {                                                             \
             m_##NAME = new TYPE(this);                                                      \
             m_##NAME->fromVariantMap(value);                                                \
+            NAME##Watch();                                                                  \
         }                                                                                   \
         emit NAME##Changed();                                                               \
     }                                                                                       \
+    /* 已创建的对象，不触发创建（供 QJsonJournal 使用）/ The object if created (used by QJsonJournal) */ \
+    Q_INVOKABLE QObject *NAME##Object() const {                                             \
+        return m_##NAME;                                                                    \
+    }                                                                                       \
     private:                                                                                \
-    TYPE* m_##NAME = nullptr;
+    void NAME##Watch() {                                                                    \
+        m_##NAME##Cache.watch(m_##NAME, [this]() { emit NAME##Changed(); });                \
+    }                                                                                       \
+    TYPE* m_##NAME = nullptr;                                                               \
+    QVariantMapCache m_##NAME##Cache{this};
 
 
 /**
@@ -147,8 +440,47 @@ Q_PROPERTY(TYPE NAME READ NAME WRITE set##NAME NOTIFY NAME##Changed)
  *    Generates QML-invokable CRUD interfaces.
  * 3. 内部对象生命周期由当前类管理 (deleteLater)。
  *    Manages the lifecycle of internal objects automatically.
+ * 4. CRUD 接口只增量更新 JSON 数组中受影响的元素；NAME##Serialization() 用于显式全量重建。
+ *    CRUD interfaces patch only the affected JSON element; NAME##Serialization() is an explicit full resync.
+ * 5. 整体赋值时复用已有对象（按位置，或按 NAME##SetReuseKey() 指定的属性），只写入变化的属性。
+ *    Whole-array assignment reuses existing objects (positionally, or by the property given to
+ *    NAME##SetReuseKey()) and writes only changed properties; see NAME##Stats().
+ * 6. NAME##IndexOf() 先比较缓存的逐项内容哈希，只为哈希相同的项生成 variantMap；
+ *    直接修改对象属性时，其 NOTIFY 信号使该行哈希失效。
+ *    NAME##IndexOf() compares cached per-item content hashes first and only builds
+ *    variant maps for matching candidates; an item's NOTIFY signals drop its row hash
+ *    when it is edited directly.
+ * 7. NAME##AppendFromStream(device) 逐个元素读取 JSON 数组或 NDJSON（见 QJsonStreamReader）。
+ *    NAME##AppendFromStream(device) reads a JSON array or NDJSON element by element
+ *    (see QJsonStreamReader) instead of parsing the whole document first.
  */
 #define Q_PROPERTY_QMLLIST(TYPE, NAME)                                                      \
+    Q_PROPERTY_QMLLIST_IMPL(TYPE, NAME, "")
+
+/**
+ * @brief Q_PROPERTY_QMLLIST_KEY
+ * 带主键的对象列表模型宏：在 Q_PROPERTY_QMLLIST 基础上维护 KEY -> 下标 的哈希索引。
+ * Keyed list model macro. Same as Q_PROPERTY_QMLLIST, plus a QHash from the KEY property
+ * to the item index, kept in sync across Append/Insert/Remove/SetAt/Deserialization.
+ * 整体赋值时也按 KEY 复用对象。Whole-array assignment also reuses objects by KEY.
+ *
+ * 额外接口 / Additional interfaces: NAME##IndexOfKey(key), NAME##GetByKey(key)。
+ *
+ * @param KEY 主键属性名 (例如 id) / Key property name (e.g. id)
+ */
+#define Q_PROPERTY_QMLLIST_KEY(TYPE, NAME, KEY)                                             \
+    Q_PROPERTY_QMLLIST_IMPL(TYPE, NAME, #KEY)                                               \
+public:                                                                                     \
+    Q_INVOKABLE int NAME##IndexOfKey(const QVariant &key) const {                           \
+        NAME##EnsureKeyIndex();                                                             \
+        return m_##NAME##KeyIndex.value(key.toString(), -1);                                \
+    }                                                                                       \
+    Q_INVOKABLE QVariantMap NAME##GetByKey(const QVariant &key) const {                     \
+        return NAME##GetAt(NAME##IndexOfKey(key));                                          \
+    }
+
+/* Q_PROPERTY_QMLLIST 与 Q_PROPERTY_QMLLIST_KEY 的共同实现 / Shared implementation */
+#define Q_PROPERTY_QMLLIST_IMPL(TYPE, NAME, KEYNAME)                                        \
     Q_PROPERTY(QJsonArray NAME READ get##NAME WRITE set##NAME NOTIFY NAME##Changed)         \
 public:                                                                                     \
     Q_SIGNAL void NAME##Changed();                                                          \
@@ -158,16 +490,16 @@ public:
     }                                                                                       \
     /* JSON 写 -> 重建对象列表 / JSON Write -> Rebuild Object List */                       \
     void set##NAME(const QJsonArray &value) {                                               \
-        qDebug() << "[Q_PROPERTY_QMLLIST] set" << #NAME << "size:" << value.size();          \
+        qCDebug(lcQJsonHelper) << "[Q_PROPERTY_QMLLIST] set" << #NAME << "size:" << value.size(); \
         if (m_##NAME##Json == value)                                                        \
             return;                                                                         \
         m_##NAME##Json = value;                                                             \
         NAME##Deserialization();                                                            \
         emit NAME##Changed();                                                               \
     }                                                                                       \
-    /* 同步对象 -> JSON / Sync Objects -> JSON */                                           \
+    /* 全量同步对象 -> JSON（显式重建）/ Full resync Objects -> JSON (explicit rebuild) */  \
     void NAME##Serialization() {                                                            \
-        qDebug() << "[Q_PROPERTY_QMLLIST] Serialization" << #NAME << "count:" << m_##NAME.size(); \
+        qCDebug(lcQJsonHelper) << "[Q_PROPERTY_QMLLIST] Serialization" << #NAME << "count:" << m_##NAME.size(); \
         QJsonArray newJson;                                                                 \
         for (const auto &item : m_##NAME) {                                                 \
             newJson.append(item->jsonObject());                                             \
@@ -175,25 +507,37 @@ public:
         m_##NAME##Json = newJson;                                                           \
         emit NAME##Changed();                                                               \
     }                                                                                       \
-    /* 同步JSON -> 对象 / Sync JSON -> Objects */                                           \
+    /* 同步JSON -> 对象（复用已有对象）/ Sync JSON -> Objects (reusing instances) */        \
     void NAME##Deserialization() {                                                          \
-        qDebug() << "[Q_PROPERTY_QMLLIST] Deserialization" << #NAME << "size:" << m_##NAME##Json.size(); \
-        for (const auto &item : m_##NAME) {                                                 \
-            item->deleteLater();                                                            \
-        }                                                                                   \
-        m_##NAME.clear();                                                                   \
-        for (const auto &obj : m_##NAME##Json) {                                            \
-            TYPE* item = new TYPE(this);                                                    \
-            item->fromJsonValue(obj);                                                       \
-            m_##NAME.append(item);                                                          \
-        }                                                                                   \
+        qCDebug(lcQJsonHelper) << "[Q_PROPERTY_QMLLIST] Deserialization" << #NAME << "size:" << m_##NAME##Json.size(); \
+        QPropertyEx::syncObjectList(this, m_##NAME, m_##NAME##Json,                         \
+                                    m_##NAME##ReuseKey, m_##NAME##Stats);                   \
+        NAME##InvalidateIndex();                                                            \
+    }                                                                                       \
+    Q_INVOKABLE void NAME##SetReuseKey(const QString &key) {                                \
+        m_##NAME##ReuseKey = key;                                                           \
+        m_##NAME##KeyIndexDirty = true;                                                     \
+    }                                                                                       \
+    Q_INVOKABLE QVariantMap NAME##Stats() const {                                           \
+        return m_##NAME##Stats.toVariantMap();                                              \
     }                                                                                       \
     /* ---------------- 查询类接口 / Search Interfaces ---------------- */                  \
     Q_INVOKABLE int NAME##IndexOf(const QVariantMap &map) const {                           \
+        NAME##EnsureHashes();                                                               \
+        const uint hash = QPropertyEx::variantMapHash(map);                                 \
         for (int i = 0; i < m_##NAME.size(); ++i) {                                         \
-            if (m_##NAME.at(i)->variantMap() == map)                                        \
-                return i;                                                                  \
-        }                                                                                  \
+            /* 行哈希按需计算 / row hashes are computed on demand */                        \
+            if (!m_##NAME##HashKnown.at(i)) {                                               \
+                const QVariantMap row = m_##NAME.at(i)->variantMap();                       \
+                m_##NAME##Hashes[i] = QPropertyEx::variantMapHash(row);                     \
+                m_##NAME##HashKnown[i] = true;                                              \
+                m_##NAME##Watcher.watch(m_##NAME.at(i));                                    \
+                if (m_##NAME##Hashes.at(i) == hash && row == map)                           \
+                    return i;                                                               \
+            } else if (m_##NAME##Hashes.at(i) == hash && m_##NAME.at(i)->variantMap() == map) { \
+                return i;                                                                   \
+            }                                                                               \
+        }                                                                                   \
         return -1;                                                                         \
     }                                                                                      \
     Q_INVOKABLE bool NAME##Contains(const QVariantMap &map) const {                         \
@@ -212,37 +556,673 @@ public:
         if (index < 0 || index >= m_##NAME.size())                                          \
             return;                                                                         \
         TYPE *item = m_##NAME.at(index);                                                    \
+        const bool keyed = !m_##NAME##KeyIndexDirty && !m_##NAME##ReuseKey.isEmpty();       \
+        const QString oldKey = keyed ? NAME##KeyOf(item) : QString();                       \
         item->fromVariantMap(map);                                                          \
-        NAME##Serialization();                                                              \
+        if (keyed && NAME##KeyOf(item) != oldKey)                                           \
+            m_##NAME##KeyIndexDirty = true;                                                 \
+        if (!m_##NAME##HashesDirty)                                                         \
+            m_##NAME##HashKnown[index] = false;                                             \
+        if (m_##NAME##Json.size() != m_##NAME.size())                                       \
+            return NAME##Serialization();                                                   \
+        m_##NAME##Json.replace(index, item->jsonObject());                                  \
+        emit NAME##Changed();                                                               \
     }                                                                                       \
     Q_INVOKABLE void NAME##Append(QVariantMap map = QVariantMap()) {                        \
-        TYPE *item = new TYPE(this);                                                        \
-        item->fromVariantMap(map);                                                          \
-        m_##NAME.append(item);                                                              \
-        NAME##Serialization();                                                              \
+        NAME##Insert(m_##NAME.size(), map);                                                 \
     }                                                                                       \
     Q_INVOKABLE void NAME##Insert(int index, const QVariantMap &map) {                      \
         TYPE *item = new TYPE(this);                                                        \
+        ++m_##NAME##Stats.created;                                                          \
+        QJSONHELPER_STAT(&TYPE::staticMetaObject, ObjectsCreated, 1);                       \
         item->fromVariantMap(map);                                                          \
         if (index < 0) index = 0;                                                           \
         if (index > m_##NAME.size()) index = m_##NAME.size();                               \
         m_##NAME.insert(index, item);                                                       \
-        NAME##Serialization();                                                              \
+        /* 增量更新索引 / Update the indexes in place */                                    \
+        NAME##KeyIndexInserted(index);                                                      \
+        if (!m_##NAME##HashesDirty) {                                                       \
+            m_##NAME##Hashes.insert(index, 0);                                              \
+            m_##NAME##HashKnown.insert(index, false);                                       \
+        }                                                                                   \
+        if (m_##NAME##Json.size() + 1 != m_##NAME.size())                                   \
+            return NAME##Serialization();                                                   \
+        m_##NAME##Json.insert(index, item->jsonObject());                                   \
+        emit NAME##Changed();                                                               \
     }                                                                                       \
     Q_INVOKABLE void NAME##Remove(int index) {                                              \
         if (index < 0 || index >= m_##NAME.size())                                          \
             return;                                                                         \
         TYPE* item = m_##NAME.takeAt(index);                                                \
+        /* 增量更新索引 / Update the indexes in place */                                    \
+        NAME##KeyIndexRemoved(index, item);                                                 \
+        if (!m_##NAME##HashesDirty) {                                                       \
+            m_##NAME##Hashes.remove(index);                                                 \
+            m_##NAME##HashKnown.remove(index);                                              \
+        }                                                                                   \
+        m_##NAME##Watcher.unwatch(item);                                                    \
         if (item) item->deleteLater();                                                      \
-        NAME##Serialization();                                                              \
+        ++m_##NAME##Stats.destroyed;                                                        \
+        QJSONHELPER_STAT(&TYPE::staticMetaObject, ObjectsDestroyed, 1);                     \
+        if (m_##NAME##Json.size() != m_##NAME.size() + 1)                                   \
+            return NAME##Serialization();                                                   \
+        m_##NAME##Json.removeAt(index);                                                     \
+        emit NAME##Changed();                                                               \
+    }                                                                                       \
+    /* 从设备流式追加（JSON 数组或 NDJSON），不构建整个文档 */                                                  \
+    /* Streams elements from a device (JSON array or NDJSON) without building a DOM */      \
+    qint64 NAME##AppendFromStream(QIODevice *device) {                                      \
+        if (m_##NAME##Json.size() != m_##NAME.size())                                       \
+            NAME##Serialization();                                                          \
+        QJsonStreamReader reader(device);                                                   \
+        const qint64 count = reader.readObjects<TYPE>(this, [this](TYPE *item) {            \
+            m_##NAME.append(item);                                                          \
+            m_##NAME##Json.append(item->jsonObject());                                      \
+            return true;                                                                    \
+        });                                                                                 \
+        m_##NAME##Stats.created += count;                                                   \
+        QJSONHELPER_STAT(&TYPE::staticMetaObject, ObjectsCreated, count);                   \
+        if (reader.hasError())                                                              \
+            qCWarning(lcQJsonHelper) << "[Q_PROPERTY_QMLLIST]" << #NAME << reader.errorString(); \
+        if (count > 0) {                                                                    \
+            NAME##InvalidateIndex();                                                        \
+            emit NAME##Changed();                                                           \
+        }                                                                                   \
+        return count;                                                                       \
     }                                                                                       \
     Q_INVOKABLE void NAME##Clear() {                                                        \
         for (auto *item : m_##NAME) {                                                       \
+            m_##NAME##Watcher.unwatch(item);                                                \
+            item->deleteLater();                                                            \
+        }                                                                                   \
+        m_##NAME##Stats.destroyed += m_##NAME.size();                                       \
+        QJSONHELPER_STAT(&TYPE::staticMetaObject, ObjectsDestroyed, m_##NAME.size());       \
+        m_##NAME.clear();                                                                   \
+        NAME##InvalidateIndex();                                                            \
+        m_##NAME##Json = QJsonArray();                                                      \
+        emit NAME##Changed();                                                               \
+    }                                                                                       \
+private:                                                                                    \
+    /* ---------------- 索引维护 / Index maintenance ---------------- */                    \
+    QString NAME##KeyOf(TYPE *item) const {                                                 \
+        return item->property(m_##NAME##ReuseKey.toLatin1().constData()).toString();        \
+    }                                                                                       \
+    void NAME##InvalidateIndex() const {                                                    \
+        m_##NAME##KeyIndexDirty = true;                                                     \
+        m_##NAME##HashesDirty = true;                                                       \
+    }                                                                                       \
+    void NAME##EnsureKeyIndex() const {                                                     \
+        if (!m_##NAME##KeyIndexDirty)                                                       \
+            return;                                                                         \
+        m_##NAME##KeyIndex.clear();                                                         \
+        m_##NAME##KeyIndexDirty = false;                                                    \
+        m_##NAME##KeyDuplicates = false;                                                    \
+        if (m_##NAME##ReuseKey.isEmpty())                                                   \
+            return;                                                                         \
+        m_##NAME##KeyIndex.reserve(m_##NAME.size());                                        \
+        /* 逆序插入，重复键保留第一个 / reverse order so the first duplicate wins */        \
+        for (int i = m_##NAME.size() - 1; i >= 0; --i) {                                    \
+            const QString key = NAME##KeyOf(m_##NAME.at(i));                                \
+            if (m_##NAME##KeyIndex.contains(key))                                           \
+                m_##NAME##KeyDuplicates = true;                                             \
+            m_##NAME##KeyIndex.insert(key, i);                                              \
+        }                                                                                   \
+    }                                                                                       \
+    /* 在 index 处插入后平移下标 / Shifts the indices after an insertion at index */        \
+    void NAME##KeyIndexInserted(int index) const {                                          \
+        if (m_##NAME##KeyIndexDirty || m_##NAME##ReuseKey.isEmpty())                        \
+            return;                                                                         \
+        if (index != m_##NAME.size() - 1) {                                                 \
+            for (QHash<QString, int>::iterator it = m_##NAME##KeyIndex.begin(); it != m_##NAME##KeyIndex.end(); ++it) { \
+                if (it.value() >= index)                                                    \
+                    ++it.value();                                                           \
+            }                                                                               \
+        }                                                                                   \
+        const QString key = NAME##KeyOf(m_##NAME.at(index));                                \
+        QHash<QString, int>::iterator it = m_##NAME##KeyIndex.find(key);                    \
+        if (it == m_##NAME##KeyIndex.end()) {                                               \
+            m_##NAME##KeyIndex.insert(key, index);                                          \
+        } else {                                                                            \
+            m_##NAME##KeyDuplicates = true;                                                 \
+            if (it.value() > index)                                                         \
+                it.value() = index;                                                         \
+        }                                                                                   \
+    }                                                                                       \
+    /* 删除 index 处的 item 后平移下标 / Shifts the indices after item was removed from index */ \
+    void NAME##KeyIndexRemoved(int index, TYPE *item) const {                               \
+        if (m_##NAME##KeyIndexDirty || m_##NAME##ReuseKey.isEmpty())                        \
+            return;                                                                         \
+        const QString key = NAME##KeyOf(item);                                              \
+        if (m_##NAME##KeyIndex.value(key, -1) == index) {                                   \
+            /* 可能有更靠后的重复键，此时重建 / a later duplicate may take over: rebuild */ \
+            if (m_##NAME##KeyDuplicates && index != m_##NAME.size()) {                      \
+                m_##NAME##KeyIndexDirty = true;                                             \
+                return;                                                                     \
+            }                                                                               \
+            m_##NAME##KeyIndex.remove(key);                                                 \
+        }                                                                                   \
+        if (index != m_##NAME.size()) {                                                     \
+            for (QHash<QString, int>::iterator it = m_##NAME##KeyIndex.begin(); it != m_##NAME##KeyIndex.end(); ++it) { \
+                if (it.value() > index)                                                     \
+                    --it.value();                                                           \
+            }                                                                               \
+        }                                                                                   \
+    }                                                                                       \
+    void NAME##EnsureHashes() const {                                                       \
+        if (m_##NAME##HashesDirty) {                                                        \
+            m_##NAME##Hashes.resize(m_##NAME.size());                                       \
+            m_##NAME##HashKnown.fill(false, m_##NAME.size());                               \
+            m_##NAME##HashesDirty = false;                                                  \
+            m_##NAME##Watcher.takeDirty();                                                  \
+            return;                                                                         \
+        }                                                                                   \
+        /* 直接修改过的对象重新计算哈希 / rehash the items edited directly */               \
+        const QSet<QObject*> dirty = m_##NAME##Watcher.takeDirty();                         \
+        if (dirty.isEmpty())                                                                \
+            return;                                                                         \
+        for (int i = 0; i < m_##NAME.size(); ++i) {                                         \
+            if (m_##NAME##HashKnown.at(i) && dirty.contains(m_##NAME.at(i)))                \
+                m_##NAME##HashKnown[i] = false;                                             \
+        }                                                                                   \
+    }                                                                                       \
+    mutable QHash<QString, int> m_##NAME##KeyIndex;                                         \
+    mutable QVector<uint> m_##NAME##Hashes;                                                 \
+    mutable QVector<bool> m_##NAME##HashKnown;                                              \
+    mutable bool m_##NAME##KeyIndexDirty = true;                                            \
+    mutable bool m_##NAME##KeyDuplicates = false;                                           \
+    mutable bool m_##NAME##HashesDirty = true;                                              \
+    /* 哈希已知的对象的 NOTIFY 信号 / NOTIFY signals of the items with a known hash */      \
+    mutable QObjectListWatcher m_##NAME##Watcher{this};                                     \
+public:                                                                                     \
+    QList<TYPE*> m_##NAME;                                                                  \
+    QJsonArray m_##NAME##Json;                                                              \
+    QString m_##NAME##ReuseKey{QStringLiteral(KEYNAME)};                                    \
+    QmlListStats m_##NAME##Stats;
+
+
+/**
+ * @brief Q_PROPERTY_QMLLIST_LAZY
+ * 惰性对象列表模型宏：JSON 数组 (m_##NAME##Json) 是唯一权威数据，TYPE 对象在首次访问时才创建。
+ * Lazy list model macro. The JSON array (m_##NAME##Json) is authoritative and TYPE
+ * instances are only created on first access (NAME##GetAt, NAME##SetAt, NAME##At).
+ *
+ * 接口与 Q_PROPERTY_QMLLIST 相同；另外可用 NAME##SetCacheLimit(n) 限制常驻对象数量，
+ * 超出时按 LRU 淘汰。内存与加载时间随访问的工作集而非列表长度增长。
+ * Same interface as Q_PROPERTY_QMLLIST. NAME##SetCacheLimit(n) caps the number of live
+ * instances; the least recently used one is evicted when the cap is exceeded. Memory and
+ * load time scale with the working set, not the list length.
+ *
+ * 通过 NAME##At() 对对象所做的修改由其 NOTIFY 信号记录，在 getNAME()、查询或淘汰前写回 JSON。
+ * Edits made through NAME##At() are recorded by the item's NOTIFY signals and written back
+ * to the JSON before getNAME(), searches and evictions.
+ *
+ * 对象生命周期：淘汰在返回事件循环后才进行，因此 NAME##At() 返回的对象至少在本轮事件循环内
+ * 有效且其修改会被记录；之后可能被淘汰并 deleteLater()。跨事件循环持有时请保留返回的
+ * QPointer 并检查是否为空，需要时重新调用 NAME##At()。
+ * Lifetime: eviction only runs once control returns to the event loop, so an object
+ * returned by NAME##At() stays alive, and its edits are recorded, at least until then.
+ * Afterwards it may be evicted and deleteLater()'d; keep the returned QPointer when
+ * holding it across event loop iterations, and call NAME##At() again once it is null.
+ */
+#define Q_PROPERTY_QMLLIST_LAZY(TYPE, NAME)                                                 \
+    Q_PROPERTY(QJsonArray NAME READ get##NAME WRITE set##NAME NOTIFY NAME##Changed)         \
+public:                                                                                     \
+    Q_SIGNAL void NAME##Changed();                                                          \
+    /* JSON 读：先写回有变化的对象 / JSON Read: writes changed objects back first */        \
+    QJsonArray get##NAME() const {                                                          \
+        NAME##Flush();                                                                      \
+        return m_##NAME##Json;                                                              \
+    }                                                                                       \
+    /* JSON 写：只丢弃已创建的对象 / JSON Write: only drops materialized objects */         \
+    void set##NAME(const QJsonArray &value) {                                               \
+        NAME##Flush();                                                                      \
+        if (m_##NAME##Json == value)                                                        \
+            return;                                                                         \
+        m_##NAME##Json = value;                                                             \
+        NAME##Deserialization();                                                            \
+        emit NAME##Changed();                                                               \
+    }                                                                                       \
+    /* 将全部已创建对象写回 JSON / Write all materialized objects back to JSON */           \
+    void NAME##Serialization() {                                                            \
+        m_##NAME##Watcher.takeDirty();                                                      \
+        for (QHash<TYPE*, int>::const_iterator it = m_##NAME##Row.constBegin();             \
+             it != m_##NAME##Row.constEnd(); ++it)                                          \
+            m_##NAME##Json.replace(it.value(), it.key()->jsonObject());                     \
+        emit NAME##Changed();                                                               \
+    }                                                                                       \
+    /* 丢弃全部对象，下次访问时按 JSON 重建 / Drop all objects; rebuilt from JSON on access */ \
+    void NAME##Deserialization() {                                                          \
+        for (TYPE *item : m_##NAME) {                                                       \
+            if (item) {                                                                     \
+                m_##NAME##Watcher.unwatch(item);                                            \
+                item->deleteLater();                                                        \
+                ++m_##NAME##Stats.destroyed;                                                \
+                QJSONHELPER_STAT(&TYPE::staticMetaObject, ObjectsDestroyed, 1);             \
+            }                                                                               \
+        }                                                                                   \
+        m_##NAME = QVector<TYPE*>(m_##NAME##Json.size(), nullptr);                          \
+        m_##NAME##Row.clear();                                                              \
+        m_##NAME##Lru.clear();                                                              \
+    }                                                                                       \
+    /* C++ 访问：按需创建对象（生命周期见上）/ C++ access: created on demand (see Lifetime) */ \
+    QPointer<TYPE> NAME##At(int index) {                                                    \
+        if (index < 0 || index >= m_##NAME.size())                                          \
+            return nullptr;                                                                 \
+        TYPE *item = m_##NAME.at(index);                                                    \
+        if (!item) {                                                                        \
+            item = new TYPE(this);                                                          \
+            ++m_##NAME##Stats.created;                                                      \
+            QJSONHELPER_STAT(&TYPE::staticMetaObject, ObjectsCreated, 1);                   \
+            QObjectHelper::qjsonvalue2qobject(m_##NAME##Json.at(index), item);              \
+            m_##NAME[index] = item;                                                         \
+            m_##NAME##Row.insert(item, index);                                              \
+            /* 对象的 NOTIFY 信号标记写回 / the item's NOTIFY signals schedule a write-back */ \
+            m_##NAME##Watcher.watch(item);                                                  \
+        }                                                                                   \
+        NAME##Touch(item);                                                                  \
+        return item;                                                                        \
+    }                                                                                       \
+    Q_INVOKABLE void NAME##SetCacheLimit(int limit) {                                       \
+        m_##NAME##CacheLimit = qMax(0, limit);                                              \
+        if (m_##NAME##CacheLimit == 0) {                                                    \
+            m_##NAME##Lru.clear();                                                          \
+            return;                                                                         \
+        }                                                                                   \
+        /* 开启 LRU 时收集当前已创建对象 / start tracking the live objects */               \
+        if (m_##NAME##Lru.isEmpty()) {                                                      \
+            for (TYPE *item : m_##NAME)                                                     \
+                if (item) m_##NAME##Lru.touch(item);                                        \
+        }                                                                                   \
+        NAME##ScheduleEvict();                                                              \
+    }                                                                                       \
+    Q_INVOKABLE int NAME##MaterializedCount() const {                                       \
+        return m_##NAME##Row.size();                                                        \
+    }                                                                                       \
+    Q_INVOKABLE QVariantMap NAME##Stats() const {                                           \
+        return m_##NAME##Stats.toVariantMap();                                              \
+    }                                                                                       \
+    /* ---------------- 查询类接口 / Search Interfaces ---------------- */                  \
+    /* 按 JSON 比较，不创建对象；缺少的属性按默认值比较 */                                  \
+    /* Compares json, creating no objects; missing properties compare as their defaults */  \
+    Q_INVOKABLE int NAME##IndexOf(const QVariantMap &map) const {                           \
+        NAME##Flush();                                                                      \
+        const QJsonObject target = QJsonObject::fromVariantMap(map);                        \
+        const QJsonObject &defaults = QPropertyEx::defaultJsonObject<TYPE>();               \
+        for (int i = 0; i < m_##NAME##Json.size(); ++i) {                                   \
+            if (QPropertyEx::equalsWithDefaults(m_##NAME##Json.at(i).toObject(), target, defaults)) \
+                return i;                                                                   \
+        }                                                                                   \
+        return -1;                                                                          \
+    }                                                                                       \
+    Q_INVOKABLE bool NAME##Contains(const QVariantMap &map) const {                         \
+        return NAME##IndexOf(map) >= 0;                                                     \
+    }                                                                                       \
+    /* ---------------- CRUD (统一命名风格 / Unified Naming Style) ---------------- */      \
+    Q_INVOKABLE int NAME##Count() const {                                                   \
+        return m_##NAME##Json.size();                                                       \
+    }                                                                                       \
+    Q_INVOKABLE QVariantMap NAME##GetAt(int index) {                                        \
+        TYPE *item = NAME##At(index);                                                       \
+        return item ? item->variantMap() : QVariantMap();                                   \
+    }                                                                                       \
+    Q_INVOKABLE void NAME##SetAt(int index, const QVariantMap &map) {                       \
+        TYPE *item = NAME##At(index);                                                       \
+        if (!item)                                                                          \
+            return;                                                                         \
+        item->fromVariantMap(map);                                                          \
+        NAME##Flush();                                                                      \
+        emit NAME##Changed();                                                               \
+    }                                                                                       \
+    Q_INVOKABLE void NAME##Append(QVariantMap map = QVariantMap()) {                        \
+        NAME##Insert(m_##NAME.size(), map);                                                 \
+    }                                                                                       \
+    Q_INVOKABLE void NAME##Insert(int index, const QVariantMap &map) {                      \
+        TYPE *item = new TYPE(this);                                                        \
+        ++m_##NAME##Stats.created;                                                          \
+        QJSONHELPER_STAT(&TYPE::staticMetaObject, ObjectsCreated, 1);                       \
+        item->fromVariantMap(map);                                                          \
+        if (index < 0) index = 0;                                                           \
+        if (index > m_##NAME.size()) index = m_##NAME.size();                               \
+        if (index < m_##NAME.size())                                                        \
+            NAME##ShiftRows(index, 1);                                                      \
+        m_##NAME.insert(index, item);                                                       \
+        m_##NAME##Json.insert(index, item->jsonObject());                                   \
+        m_##NAME##Row.insert(item, index);                                                  \
+        m_##NAME##Watcher.watch(item);                                                      \
+        NAME##Touch(item);                                                                  \
+        emit NAME##Changed();                                                               \
+    }                                                                                       \
+    Q_INVOKABLE void NAME##Remove(int index) {                                              \
+        if (index < 0 || index >= m_##NAME.size())                                          \
+            return;                                                                         \
+        TYPE *item = m_##NAME.takeAt(index);                                                \
+        if (item) {                                                                         \
+            m_##NAME##Lru.remove(item);                                                     \
+            m_##NAME##Row.remove(item);                                                     \
+            m_##NAME##Watcher.unwatch(item);                                                \
+            item->deleteLater();                                                            \
+            ++m_##NAME##Stats.destroyed;                                                    \
+            QJSONHELPER_STAT(&TYPE::staticMetaObject, ObjectsDestroyed, 1);                 \
+        }                                                                                   \
+        if (index < m_##NAME.size())                                                        \
+            NAME##ShiftRows(index + 1, -1);                                                 \
+        m_##NAME##Json.removeAt(index);                                                     \
+        emit NAME##Changed();                                                               \
+    }                                                                                       \
+    /* 从设备流式追加（JSON 数组或 NDJSON），只追加 JSON，不创建对象 */                     \
+    /* Streams elements from a device (JSON array or NDJSON); only the JSON is kept */      \
+    qint64 NAME##AppendFromStream(QIODevice *device) {                                      \
+        QJsonStreamReader reader(device);                                                   \
+        qint64 count = 0;                                                                   \
+        QJsonValue value;                                                                   \
+        while (reader.readNext(&value)) {                                                   \
+            if (!value.isObject())                                                          \
+                continue;                                                                   \
+            m_##NAME##Json.append(value);                                                   \
+            m_##NAME.append(nullptr);                                                       \
+            ++count;                                                                        \
+        }                                                                                   \
+        if (reader.hasError())                                                              \
+            qCWarning(lcQJsonHelper) << "[Q_PROPERTY_QMLLIST_LAZY]" << #NAME << reader.errorString(); \
+        if (count > 0)                                                                      \
+            emit NAME##Changed();                                                           \
+        return count;                                                                       \
+    }                                                                                       \
+    Q_INVOKABLE void NAME##Clear() {                                                        \
+        m_##NAME##Json = QJsonArray();                                                      \
+        NAME##Deserialization();                                                            \
+        emit NAME##Changed();                                                               \
+    }                                                                                       \
+private:                                                                                    \
+    /* 写回发出过 NOTIFY 信号的对象 / Write back the objects that notified */               \
+    void NAME##Flush() const {                                                              \
+        const QSet<QObject*> dirty = m_##NAME##Watcher.takeDirty();                         \
+        for (QObject *object : dirty) {                                                     \
+            TYPE *item = static_cast<TYPE*>(object);                                        \
+            const int index = m_##NAME##Row.value(item, -1);                                \
+            if (index >= 0)                                                                 \
+                m_##NAME##Json.replace(index, item->jsonObject());                          \
+        }                                                                                   \
+    }                                                                                       \
+    /* 行号 >= from 的已创建对象移动 delta / Shift the rows of live objects at or after from */ \
+    void NAME##ShiftRows(int from, int delta) {                                             \
+        if (m_##NAME##Row.isEmpty())                                                        \
+            return;                                                                         \
+        for (QHash<TYPE*, int>::iterator it = m_##NAME##Row.begin(); it != m_##NAME##Row.end(); ++it) { \
+            if (it.value() >= from)                                                         \
+                it.value() += delta;                                                        \
+        }                                                                                   \
+    }                                                                                       \
+    /* ---------------- LRU ---------------- */                                             \
+    void NAME##Touch(TYPE *item) {                                                          \
+        if (m_##NAME##CacheLimit == 0)                                                      \
+            return;                                                                         \
+        m_##NAME##Lru.touch(item);                                                          \
+        NAME##ScheduleEvict();                                                              \
+    }                                                                                       \
+    /* 回到事件循环后再淘汰，本轮返回的对象保持有效 / evict once the event loop turns */    \
+    void NAME##ScheduleEvict() {                                                            \
+        if (m_##NAME##EvictPending || m_##NAME##Lru.size() <= m_##NAME##CacheLimit)         \
+            return;                                                                         \
+        m_##NAME##EvictPending = true;                                                      \
+        QTimer::singleShot(0, this, [this]() {                                              \
+            m_##NAME##EvictPending = false;                                                 \
+            NAME##Evict();                                                                  \
+        });                                                                                 \
+    }                                                                                       \
+    void NAME##Evict() {                                                                    \
+        if (m_##NAME##Lru.size() <= m_##NAME##CacheLimit)                                   \
+            return;                                                                         \
+        /* 先写回修改，淘汰的对象即为干净的 / write edits back first, victims are then clean */ \
+        NAME##Flush();                                                                      \
+        while (m_##NAME##Lru.size() > m_##NAME##CacheLimit) {                               \
+            TYPE *victim = m_##NAME##Lru.takeOldest();                                      \
+            const int index = m_##NAME##Row.take(victim);                                   \
+            m_##NAME[index] = nullptr;                                                      \
+            m_##NAME##Watcher.unwatch(victim);                                              \
+            victim->deleteLater();                                                          \
+            ++m_##NAME##Stats.destroyed;                                                    \
+            QJSONHELPER_STAT(&TYPE::staticMetaObject, ObjectsDestroyed, 1);                 \
+        }                                                                                   \
+    }                                                                                       \
+    QPropertyEx::LruList<TYPE> m_##NAME##Lru;                                               \
+    QHash<TYPE*, int> m_##NAME##Row;                                                        \
+    mutable QObjectListWatcher m_##NAME##Watcher{this};                                     \
+    int m_##NAME##CacheLimit = 0;                                                           \
+    bool m_##NAME##EvictPending = false;                                                    \
+public:                                                                                     \
+    QVector<TYPE*> m_##NAME;                                                                \
+    mutable QJsonArray m_##NAME##Json;                                                      \
+    QmlListStats m_##NAME##Stats;
+
+
+/**
+ * @brief Q_PROPERTY_QMLLIST_OBJECTS
+ * 单一存储的对象列表模型宏：对象列表 (m_##NAME) 是唯一数据源，不再常驻一份镜像 QJsonArray。
+ * Single-storage list model macro. The object list (m_##NAME) is the only copy of the data;
+ * no mirrored QJsonArray is kept alongside it.
+ *
+ * 接口与 Q_PROPERTY_QMLLIST 相同（包括 NAME##Serialization()/NAME##Deserialization()），区别在于：
+ * Same interface as Q_PROPERTY_QMLLIST (NAME##Serialization() and NAME##Deserialization()
+ * included), except that:
+ * 1. getNAME() 按需由对象生成 JSON 数组，缓存只保留到下一次修改（结构变化或元素的 NOTIFY 信号）；
+ *    QML 可用 NAME##At()/NAME##GetAt() 按行读取，无需整个数组。
+ *    getNAME() builds the JSON array from the objects on demand. The array is dropped by the
+ *    next change (a structural edit or an item's NOTIFY signal), so it is not resident while
+ *    the list is edited. QML can read single rows with NAME##At() / NAME##GetAt().
+ * 2. 变化检测使用代数计数器 (QObjectListWatcher)，而非深度比较数组：setNAME() 同步对象后，
+ *    仅当有对象发出 NOTIFY 信号或列表结构改变时才发出 NAME##Changed()。
+ *    Change detection uses generation counters (QObjectListWatcher) instead of deep array
+ *    compares: setNAME() syncs the objects and emits NAME##Changed() only if an object
+ *    notified or the list structure changed. NAME##Generation() exposes the counter.
+ * 3. getNAME() 返回对象的当前状态，包括直接对对象所做的修改；NAME##Serialization() 只发出
+ *    NAME##Changed()，NAME##Deserialization() 只重建派生索引（没有独立的 JSON 需要同步）。
+ *    getNAME() reflects edits made directly on the objects. NAME##Serialization() only emits
+ *    NAME##Changed() and NAME##Deserialization() only rebuilds the derived indexes, as there
+ *    is no separate JSON copy to sync.
+ *    TYPE 的属性需带 NOTIFY 信号（Q_PROPERTY_AUTO* 均满足）。
+ *    TYPE's properties need NOTIFY signals for this (all Q_PROPERTY_AUTO* properties have one).
+ * 4. NAME##IndexOfKey() 使用 NAME##SetReuseKey() 设置的属性。
+ *    NAME##IndexOfKey() looks up the property set with NAME##SetReuseKey().
+ * 5. NAME##IndexOf() 缓存逐行哈希：结构变化后全部重算，否则只重算发出过 NOTIFY 信号的行。
+ *    NAME##IndexOf() caches per-row hashes. A structural change rehashes every row;
+ *    otherwise only the rows whose item notified since the last search are rehashed.
+ */
+#define Q_PROPERTY_QMLLIST_OBJECTS(TYPE, NAME)                                              \
+    Q_PROPERTY(QJsonArray NAME READ get##NAME WRITE set##NAME NOTIFY NAME##Changed)         \
+public:                                                                                     \
+    Q_SIGNAL void NAME##Changed();                                                          \
+    /* JSON 读：按需生成，下一次修改时丢弃 / JSON Read: built on demand, dropped by the next change */ \
+    QJsonArray get##NAME() const {                                                          \
+        if (m_##NAME##Watcher.hasJson())                                                    \
+            return m_##NAME##Watcher.json();                                                \
+        QJsonArray json;                                                                    \
+        for (TYPE *item : m_##NAME)                                                         \
+            json.append(item->jsonObject());                                                \
+        m_##NAME##Watcher.setJson(json);                                                    \
+        return json;                                                                        \
+    }                                                                                       \
+    /* JSON 写 -> 同步对象列表 / JSON Write -> Sync Object List */                          \
+    void set##NAME(const QJsonArray &value) {                                               \
+        qCDebug(lcQJsonHelper) << "[Q_PROPERTY_QMLLIST_OBJECTS] set" << #NAME << "size:" << value.size(); \
+        const quint64 before = m_##NAME##Watcher.generation();                              \
+        const QList<TYPE*> old = m_##NAME;                                                  \
+        QPropertyEx::syncObjectList(this, m_##NAME, value,                                  \
+                                    m_##NAME##ReuseKey, m_##NAME##Stats);                   \
+        if (m_##NAME != old) {                                                              \
+            QSet<TYPE*> stale;                                                              \
+            for (TYPE *item : old)                                                          \
+                stale.insert(item);                                                         \
+            for (TYPE *item : m_##NAME) {                                                   \
+                if (!stale.remove(item))                                                    \
+                    m_##NAME##Watcher.watch(item);                                          \
+            }                                                                               \
+            for (TYPE *item : stale)                                                        \
+                m_##NAME##Watcher.unwatch(item);                                            \
+            NAME##StructureChanged();                                                       \
+        }                                                                                   \
+        if (m_##NAME##Watcher.generation() != before)                                       \
+            emit NAME##Changed();                                                           \
+    }                                                                                       \
+    /* 对象即数据源：通知 JSON 视图已变化 / Objects are authoritative: announce the JSON view changed */ \
+    void NAME##Serialization() {                                                            \
+        NAME##StructureChanged();                                                           \
+        emit NAME##Changed();                                                               \
+    }                                                                                       \
+    /* 没有独立的 JSON 需要同步，只重建派生索引 / No JSON copy to sync; rebuilds derived indexes */ \
+    void NAME##Deserialization() {                                                          \
+        NAME##StructureChanged();                                                           \
+    }                                                                                       \
+    Q_INVOKABLE quint64 NAME##Generation() const {                                          \
+        return m_##NAME##Watcher.generation();                                              \
+    }                                                                                       \
+    Q_INVOKABLE void NAME##SetReuseKey(const QString &key) {                                \
+        m_##NAME##ReuseKey = key;                                                           \
+        m_##NAME##KeyIndexGeneration = quint64(-1);                                         \
+    }                                                                                       \
+    Q_INVOKABLE QVariantMap NAME##Stats() const {                                           \
+        return m_##NAME##Stats.toVariantMap();                                              \
+    }                                                                                       \
+    /* ---------------- 查询类接口 / Search Interfaces ---------------- */                  \
+    Q_INVOKABLE int NAME##IndexOf(const QVariantMap &map) const {                           \
+        NAME##EnsureHashes();                                                               \
+        const uint hash = QPropertyEx::variantMapHash(map);                                 \
+        for (int i = 0; i < m_##NAME.size(); ++i) {                                         \
+            if (m_##NAME##Hashes.at(i) == hash && m_##NAME.at(i)->variantMap() == map)      \
+                return i;                                                                   \
+        }                                                                                   \
+        return -1;                                                                          \
+    }                                                                                       \
+    Q_INVOKABLE bool NAME##Contains(const QVariantMap &map) const {                         \
+        return NAME##IndexOf(map) >= 0;                                                     \
+    }                                                                                       \
+    Q_INVOKABLE int NAME##IndexOfKey(const QVariant &key) const {                           \
+        NAME##EnsureKeyIndex();                                                             \
+        return m_##NAME##KeyIndex.value(key.toString(), -1);                                \
+    }                                                                                       \
+    /* ---------------- CRUD ---------------- */                                            \
+    Q_INVOKABLE int NAME##Count() const {                                                   \
+        return m_##NAME.size();                                                             \
+    }                                                                                       \
+    /* 按行访问，QML 可直接绑定元素属性 / Per-row access; QML can bind to the item's properties */ \
+    Q_INVOKABLE QObject *NAME##At(int index) const {                                        \
+        if (index < 0 || index >= m_##NAME.size())                                          \
+            return nullptr;                                                                 \
+        return m_##NAME.at(index);                                                          \
+    }                                                                                       \
+    Q_INVOKABLE QVariantMap NAME##GetAt(int index) const {                                  \
+        if (index < 0 || index >= m_##NAME.size())                                          \
+            return QVariantMap();                                                           \
+        return m_##NAME.at(index)->variantMap();                                            \
+    }                                                                                       \
+    Q_INVOKABLE void NAME##SetAt(int index, const QVariantMap &map) {                       \
+        if (index < 0 || index >= m_##NAME.size())                                          \
+            return;                                                                         \
+        /* NOTIFY 信号会标记该元素 / the item's NOTIFY signals mark it dirty */             \
+        m_##NAME.at(index)->fromVariantMap(map);                                            \
+        emit NAME##Changed();                                                               \
+    }                                                                                       \
+    Q_INVOKABLE void NAME##Append(QVariantMap map = QVariantMap()) {                        \
+        NAME##Insert(m_##NAME.size(), map);                                                 \
+    }                                                                                       \
+    Q_INVOKABLE void NAME##Insert(int index, const QVariantMap &map) {                      \
+        TYPE *item = new TYPE(this);                                                        \
+        ++m_##NAME##Stats.created;                                                          \
+        QJSONHELPER_STAT(&TYPE::staticMetaObject, ObjectsCreated, 1);                       \
+        item->fromVariantMap(map);                                                          \
+        if (index < 0) index = 0;                                                           \
+        if (index > m_##NAME.size()) index = m_##NAME.size();                               \
+        m_##NAME.insert(index, item);                                                       \
+        m_##NAME##Watcher.watch(item);                                                      \
+        NAME##StructureChanged();                                                           \
+        emit NAME##Changed();                                                               \
+    }                                                                                       \
+    Q_INVOKABLE void NAME##Remove(int index) {                                              \
+        if (index < 0 || index >= m_##NAME.size())                                          \
+            return;                                                                         \
+        TYPE *item = m_##NAME.takeAt(index);                                                \
+        m_##NAME##Watcher.unwatch(item);                                                    \
+        item->deleteLater();                                                                \
+        ++m_##NAME##Stats.destroyed;                                                        \
+        QJSONHELPER_STAT(&TYPE::staticMetaObject, ObjectsDestroyed, 1);                     \
+        NAME##StructureChanged();                                                           \
+        emit NAME##Changed();                                                               \
+    }                                                                                       \
+    /* 从设备流式追加（JSON 数组或 NDJSON）/ Streams elements from a device (JSON array or NDJSON) */ \
+    qint64 NAME##AppendFromStream(QIODevice *device) {                                      \
+        QJsonStreamReader reader(device);                                                   \
+        const qint64 count = reader.readObjects<TYPE>(this, [this](TYPE *item) {            \
+            m_##NAME.append(item);                                                          \
+            m_##NAME##Watcher.watch(item);                                                  \
+            return true;                                                                    \
+        });                                                                                 \
+        m_##NAME##Stats.created += count;                                                   \
+        QJSONHELPER_STAT(&TYPE::staticMetaObject, ObjectsCreated, count);                   \
+        if (reader.hasError())                                                              \
+            qCWarning(lcQJsonHelper) << "[Q_PROPERTY_QMLLIST_OBJECTS]" << #NAME << reader.errorString(); \
+        if (count > 0) {                                                                    \
+            NAME##StructureChanged();                                                       \
+            emit NAME##Changed();                                                           \
+        }                                                                                   \
+        return count;                                                                       \
+    }                                                                                       \
+    Q_INVOKABLE void NAME##Clear() {                                                        \
+        for (TYPE *item : m_##NAME) {                                                       \
+            m_##NAME##Watcher.unwatch(item);                                                \
             item->deleteLater();                                                            \
         }                                                                                   \
+        m_##NAME##Stats.destroyed += m_##NAME.size();                                       \
+        QJSONHELPER_STAT(&TYPE::staticMetaObject, ObjectsDestroyed, m_##NAME.size());       \
         m_##NAME.clear();                                                                   \
-        NAME##Serialization();                                                              \
+        NAME##StructureChanged();                                                           \
+        emit NAME##Changed();                                                               \
+    }                                                                                       \
+private:                                                                                    \
+    /* 结构变化（同时丢弃 JSON 缓存）/ Structural change (also drops the JSON cache) */     \
+    void NAME##StructureChanged() {                                                         \
+        m_##NAME##Watcher.touch();                                                          \
+        ++m_##NAME##Structure;                                                              \
+    }                                                                                       \
+    QString NAME##KeyOf(TYPE *item) const {                                                 \
+        return item->property(m_##NAME##ReuseKey.toLatin1().constData()).toString();        \
+    }                                                                                       \
+    void NAME##EnsureKeyIndex() const {                                                     \
+        const quint64 generation = m_##NAME##Watcher.generation();                          \
+        if (m_##NAME##KeyIndexGeneration == generation)                                     \
+            return;                                                                         \
+        m_##NAME##KeyIndex.clear();                                                         \
+        m_##NAME##KeyIndex.reserve(m_##NAME.size());                                        \
+        /* 逆序插入，重复键保留第一个 / reverse order so the first duplicate wins */        \
+        for (int i = m_##NAME.size() - 1; i >= 0; --i)                                      \
+            m_##NAME##KeyIndex.insert(NAME##KeyOf(m_##NAME.at(i)), i);                      \
+        m_##NAME##KeyIndexGeneration = generation;                                          \
+    }                                                                                       \
+    void NAME##EnsureHashes() const {                                                       \
+        /* 结构变化后全部重算 / rehash everything after a structural change */              \
+        if (m_##NAME##HashesStructure != m_##NAME##Structure) {                             \
+            m_##NAME##Watcher.takeDirty();                                                  \
+            m_##NAME##Hashes.resize(m_##NAME.size());                                       \
+            for (int i = 0; i < m_##NAME.size(); ++i)                                       \
+                m_##NAME##Hashes[i] = QPropertyEx::variantMapHash(m_##NAME.at(i)->variantMap()); \
+            m_##NAME##HashesStructure = m_##NAME##Structure;                                \
+            return;                                                                         \
+        }                                                                                   \
+        /* 否则只重算发出过 NOTIFY 的元素 / otherwise only the items that notified */       \
+        const QSet<QObject*> dirty = m_##NAME##Watcher.takeDirty();                         \
+        if (dirty.isEmpty())                                                                \
+            return;                                                                         \
+        for (int i = 0; i < m_##NAME.size(); ++i) {                                         \
+            if (dirty.contains(m_##NAME.at(i)))                                             \
+                m_##NAME##Hashes[i] = QPropertyEx::variantMapHash(m_##NAME.at(i)->variantMap()); \
+        }                                                                                   \
     }                                                                                       \
-public:                                                                                   \
+    mutable QObjectListWatcher m_##NAME##Watcher{this};                                     \
+    mutable QHash<QString, int> m_##NAME##KeyIndex;                                         \
+    mutable quint64 m_##NAME##KeyIndexGeneration = quint64(-1);                             \
+    mutable QVector<uint> m_##NAME##Hashes;                                                 \
+    quint64 m_##NAME##Structure = 0;                                                        \
+    mutable quint64 m_##NAME##HashesStructure = quint64(-1);                                \
+public:                                                                                     \
     QList<TYPE*> m_##NAME;                                                                  \
-    QJsonArray m_##NAME##Json;
+    QString m_##NAME##ReuseKey;                                                             \
+    QmlListStats m_##NAME##Stats;
@@ -0,0 +1,73 @@
+﻿#include "qvariantmapcache.h"
+
+#include <QtCore/QMetaMethod>
+#include <QtCore/QMetaProperty>
+
+#include "qobjecthelper.h"
+
+QVariantMapCache::QVariantMapCache(QObject *parent)
+  : QObject(parent)
+  , valid_(false)
+{
+}
+
+/**
+* This method connects to the NOTIFY signals of @p target's readable
+* properties, replacing the previous target.
+*
+* @param target The object whose variant map is cached.
+* @param onInvalidated Called when a cached map is dropped because the
+* target changed.
+*/
+void QVariantMapCache::watch(QObject *target, const std::function<void()> &onInvalidated)
+{
+    if (target_)
+        disconnect(target_.data(), nullptr, this, nullptr);
+    target_ = target;
+    onInvalidated_ = onInvalidated;
+    valid_ = false;
+    map_.clear();
+    if (!target)
+        return;
+
+    const QMetaMethod slot = staticMetaObject.method(
+                staticMetaObject.indexOfSlot("onPropertyNotify()"));
+    const QMetaObject *metaobject = target->metaObject();
+    for (int i = 0; i < metaobject->propertyCount(); ++i) {
+        const QMetaProperty metaproperty = metaobject->property(i);
+        if (metaproperty.isReadable() && metaproperty.hasNotifySignal())
+            connect(target, metaproperty.notifySignal(), this, slot, Qt::UniqueConnection);
+    }
+}
+
+/**
+* This method returns the variant map of the watched object, building it
+* only when a property changed since the last call.
+*/
+QVariantMap QVariantMapCache::map()
+{
+    if (!target_)
+        return QVariantMap();
+    if (!valid_) {
+        map_ = QObjectHelper::qobject2variantmap(target_.data());
+        valid_ = true;
+    }
+    return map_;
+}
+
+void QVariantMapCache::invalidate()
+{
+    valid_ = false;
+    map_.clear();
+}
+
+void QVariantMapCache::onPropertyNotify()
+{
+    // Listeners were told on the first change; until somebody reads the
+    // map again there is nothing new to report.
+    if (!valid_)
+        return;
+    invalidate();
+    if (onInvalidated_)
+        onInvalidated_();
+}
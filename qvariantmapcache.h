@@ -0,0 +1,50 @@
+﻿#ifndef QVARIANTMAPCACHE_H
+#define QVARIANTMAPCACHE_H
+
+#include <QtCore/QObject>
+#include <QtCore/QPointer>
+#include <QtCore/QVariantMap>
+
+#include <functional>
+
+/**
+* @brief QObjectHelper::qobject2variantmap() of one object, kept until the
+* object changes.
+*
+* watch() connects to the NOTIFY signal of every readable property of the
+* target; the first notification after the map was built drops it and runs
+* the invalidation callback. Q_PROPERTY_QML uses the callback to emit its
+* own NAME##Changed(), which is a NOTIFY signal of the enclosing object, so
+* nested Q_PROPERTY_QML levels invalidate each other bottom-up and untouched
+* subtrees keep their cached maps.
+*
+* Changes inside objects held by plain QObject* properties of the target
+* are not seen; only the pointer changing is.
+*/
+class QVariantMapCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit QVariantMapCache(QObject *parent = nullptr);
+
+    // Starts watching @p target (nullptr to stop) and drops the cached map.
+    void watch(QObject *target, const std::function<void()> &onInvalidated = std::function<void()>());
+
+    QVariantMap map();
+
+    bool isValid() const { return valid_; }
+
+    void invalidate();
+
+private slots:
+    void onPropertyNotify();
+
+private:
+    QPointer<QObject> target_;
+    std::function<void()> onInvalidated_;
+    QVariantMap map_;
+    bool valid_;
+};
+
+#endif // QVARIANTMAPCACHE_H
@@ -0,0 +1,7 @@
+TEMPLATE = app
+TARGET = tst_qjsonbase64
+
+include(../tests.pri)
+
+SOURCES += \
+    $$PWD/tst_qjsonbase64.cpp
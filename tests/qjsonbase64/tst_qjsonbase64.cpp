@@ -0,0 +1,162 @@
+#include <QtCore/QTemporaryDir>
+#include <QtTest/QtTest>
+
+#include "qjsonbase64.h"
+#include "qjsonblobstore.h"
+#include "qjsonhelper.h"
+#include "qobjecthelper.h"
+#include "qpropertyex.h"
+
+class BlobObject : public QJsonHelper {
+    Q_OBJECT
+    Q_PROPERTY_AUTO(QByteArray, data)
+public:
+    Q_INVOKABLE explicit BlobObject(QObject *parent = nullptr) : QJsonHelper(parent) {}
+};
+
+class tst_QJsonBase64 : public QObject {
+    Q_OBJECT
+
+private slots:
+    void roundTrip_data();
+    void roundTrip();
+    void padding_data();
+    void padding();
+    void invalid_data();
+    void invalid();
+    void fromTextFallback();
+    void variantBlobReference();
+};
+
+namespace {
+
+// Deterministic bytes covering all 256 values.
+QByteArray sample(int size)
+{
+    QByteArray bytes(size, Qt::Uninitialized);
+    for (int i = 0; i < size; ++i)
+        bytes[i] = char((i * 167 + 13) & 0xff);
+    return bytes;
+}
+
+} // namespace
+
+// Sizes 0..64 cover the scalar tail after every SIMD block count, plus a
+// large buffer that runs mostly through the blocks.
+void tst_QJsonBase64::roundTrip_data()
+{
+    QTest::addColumn<QByteArray>("bytes");
+    for (int size = 0; size <= 64; ++size)
+        QTest::newRow(qPrintable(QString::number(size))) << sample(size);
+    QTest::newRow("65536") << sample(65536);
+}
+
+void tst_QJsonBase64::roundTrip()
+{
+    QFETCH(QByteArray, bytes);
+
+    const QByteArray expected = bytes.toBase64();
+    QCOMPARE(QJsonBase64::encodedLength(bytes.size()), expected.size());
+    QCOMPARE(QJsonBase64::encode(bytes), expected);
+    QCOMPARE(QJsonBase64::encodeToString(bytes), QString::fromLatin1(expected));
+
+    QByteArray decoded;
+    QVERIFY(QJsonBase64::decode(expected.constData(), expected.size(), &decoded));
+    QCOMPARE(decoded, bytes);
+    decoded.clear();
+    QVERIFY(QJsonBase64::decode(QString::fromLatin1(expected), &decoded));
+    QCOMPARE(decoded, bytes);
+    QCOMPARE(QJsonBase64::fromText(QString::fromLatin1(expected)), QByteArray::fromBase64(expected));
+}
+
+void tst_QJsonBase64::padding_data()
+{
+    QTest::addColumn<QString>("text");
+    QTest::addColumn<QByteArray>("bytes");
+
+    QTest::newRow("two") << QStringLiteral("QQ==") << QByteArray("A");
+    QTest::newRow("one") << QStringLiteral("QUI=") << QByteArray("AB");
+    QTest::newRow("none") << QStringLiteral("QUJD") << QByteArray("ABC");
+    QTest::newRow("two omitted") << QStringLiteral("QQ") << QByteArray("A");
+    QTest::newRow("one omitted") << QStringLiteral("QUI") << QByteArray("AB");
+    QTest::newRow("after block") << QStringLiteral("QUJDREVGR0hJSktMTU5PUFFSUw==")
+                                 << QByteArray("ABCDEFGHIJKLMNOPQRS");
+}
+
+void tst_QJsonBase64::padding()
+{
+    QFETCH(QString, text);
+    QFETCH(QByteArray, bytes);
+
+    QByteArray decoded;
+    QVERIFY(QJsonBase64::decode(text, &decoded));
+    QCOMPARE(decoded, bytes);
+    QCOMPARE(decoded, QByteArray::fromBase64(text.toLatin1()));
+}
+
+void tst_QJsonBase64::invalid_data()
+{
+    QTest::addColumn<QString>("text");
+
+    QTest::newRow("one char") << QStringLiteral("Q");
+    QTest::newRow("five chars") << QStringLiteral("QUJDR");
+    QTest::newRow("three pads") << QStringLiteral("Q===");
+    QTest::newRow("short padding") << QStringLiteral("QQ=");
+    QTest::newRow("inner pad") << QStringLiteral("QQ==QUJD");
+    QTest::newRow("space") << QStringLiteral("QU JD");
+    QTest::newRow("newline") << QStringLiteral("QUJD\nQUJD");
+    QTest::newRow("url alphabet") << QStringLiteral("-_-_");
+
+    // in the middle of a 16 character block
+    const QString block = QString::fromLatin1(sample(48).toBase64());
+    QString star = block;
+    star[20] = QLatin1Char('*');
+    QTest::newRow("block star") << star;
+    // UTF-16 units that narrow to 0xff and 0x00 when packed
+    QString wide = block;
+    wide[20] = QChar(ushort(0x0141));
+    QTest::newRow("block U+0141") << wide;
+    QString negative = block;
+    negative[20] = QChar(ushort(0x8041));
+    QTest::newRow("block U+8041") << negative;
+}
+
+void tst_QJsonBase64::invalid()
+{
+    QFETCH(QString, text);
+
+    QByteArray decoded;
+    QVERIFY(!QJsonBase64::decode(text, &decoded));
+    const QByteArray latin1 = text.toLatin1();
+    if (QString::fromLatin1(latin1) == text)
+        QVERIFY(!QJsonBase64::decode(latin1.constData(), latin1.size(), &decoded));
+}
+
+void tst_QJsonBase64::fromTextFallback()
+{
+    QCOMPARE(QJsonBase64::fromText(QStringLiteral("QU JD\nQUJD")), QByteArray("ABCABC"));
+    QCOMPARE(QJsonBase64::fromText(QString()), QByteArray());
+}
+
+// Blob references produced by QVariantMapSink are resolved when the map is
+// written back through qvariantmap2qobject().
+void tst_QJsonBase64::variantBlobReference()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QJsonBlobStore store(dir.path(), 16);
+    QJsonBlobStore::Scope scope(&store);
+
+    BlobObject source;
+    source.setdata(sample(1024));
+    const QVariantMap map = QObjectHelper::qobject2variantmap(&source);
+    QVERIFY(QJsonBlobStore::isReference(QJsonValue::fromVariant(map.value(QStringLiteral("data")))));
+
+    BlobObject target;
+    QObjectHelper::qvariantmap2qobject(map, &target);
+    QCOMPARE(target.data(), source.data());
+}
+
+QTEST_MAIN(tst_QJsonBase64)
+
+#include "tst_qjsonbase64.moc"
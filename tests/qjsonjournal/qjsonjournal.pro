@@ -0,0 +1,7 @@
+TEMPLATE = app
+TARGET = tst_qjsonjournal
+
+include(../tests.pri)
+
+SOURCES += \
+    $$PWD/tst_qjsonjournal.cpp
@@ -0,0 +1,153 @@
+#include <QtCore/QTemporaryDir>
+#include <QtTest/QtTest>
+
+#include "qjsonhelper.h"
+#include "qjsonjournal.h"
+#include "qpropertyex.h"
+
+class Note : public QJsonHelper {
+    Q_OBJECT
+    Q_PROPERTY_AUTO(QString, title)
+    Q_PROPERTY_AUTOINIT(int, count, 0)
+public:
+    Q_INVOKABLE explicit Note(QObject *parent = nullptr) : QJsonHelper(parent) {}
+};
+
+class tst_QJsonJournal : public QObject {
+    Q_OBJECT
+
+private slots:
+    void editsAfterSaveSurvive_data();
+    void editsAfterSaveSurvive();
+    void editDuringSaveAsyncSurvives();
+    void staleLogRestartedOnOpen();
+};
+
+namespace {
+
+enum SaveKind { Save, StaticSave, SaveAsync, SaveBinary };
+
+bool saveWith(Note *note, const QString &fpath, int kind)
+{
+    switch (kind) {
+    case Save:
+        return note->save(fpath);
+    case StaticSave:
+        return QJsonHelper::save(note, fpath);
+    case SaveAsync: {
+        QSignalSpy finished(note, &QJsonHelper::saveFinished);
+        note->saveAsync(fpath);
+        return finished.wait() && finished.first().at(1).toBool();
+    }
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+    case SaveBinary:
+        return note->saveBinary(fpath);
+#endif
+    default:
+        return false;
+    }
+}
+
+} // namespace
+
+void tst_QJsonJournal::editsAfterSaveSurvive_data()
+{
+    QTest::addColumn<int>("kind");
+    QTest::newRow("save") << int(Save);
+    QTest::newRow("static save") << int(StaticSave);
+    QTest::newRow("saveAsync") << int(SaveAsync);
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+    QTest::newRow("saveBinary") << int(SaveBinary);
+#endif
+}
+
+// journal on -> edit -> save -> edit -> reload: both edits are there
+void tst_QJsonJournal::editsAfterSaveSurvive()
+{
+    QFETCH(int, kind);
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fpath = dir.filePath(QStringLiteral("note.json"));
+
+    {
+        Note note;
+        QVERIFY(note.save(fpath));
+        QVERIFY(note.enableJournal(fpath));
+        note.settitle(QStringLiteral("first"));
+        QVERIFY(saveWith(&note, fpath, kind));
+        note.setcount(2);
+    }
+
+    Note loaded;
+    QVERIFY(loaded.enableJournal(fpath));
+    QVERIFY(loaded.load(fpath));
+    QCOMPARE(loaded.title(), QStringLiteral("first"));
+    QCOMPARE(loaded.count(), 2);
+}
+
+// an edit made while the async write is running is not in the new
+// snapshot and has to stay in the journal
+void tst_QJsonJournal::editDuringSaveAsyncSurvives()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fpath = dir.filePath(QStringLiteral("note.json"));
+
+    {
+        Note note;
+        QVERIFY(note.save(fpath));
+        QVERIFY(note.enableJournal(fpath));
+        note.settitle(QStringLiteral("first"));
+        QSignalSpy finished(&note, &QJsonHelper::saveFinished);
+        note.saveAsync(fpath);
+        QTest::qWait(0);    // the snapshot is taken, the write may still run
+        note.setcount(3);
+        QVERIFY(finished.wait());
+        QVERIFY(finished.first().at(1).toBool());
+    }
+
+    Note loaded;
+    QVERIFY(loaded.enableJournal(fpath));
+    QVERIFY(loaded.load(fpath));
+    QCOMPARE(loaded.title(), QStringLiteral("first"));
+    QCOMPARE(loaded.count(), 3);
+}
+
+// a log written against another snapshot is started over by open(), so
+// the records appended after it are replayed
+void tst_QJsonJournal::staleLogRestartedOnOpen()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fpath = dir.filePath(QStringLiteral("note.json"));
+
+    {
+        Note note;
+        QVERIFY(note.save(fpath));
+        QVERIFY(note.enableJournal(fpath));
+        note.settitle(QStringLiteral("old"));
+    }
+    {
+        // rewritten by someone that does not journal
+        Note other;
+        other.settitle(QStringLiteral("other"));
+        QVERIFY(QJsonHelper::save(&other, fpath));
+    }
+    {
+        Note note;
+        QVERIFY(note.enableJournal(fpath));
+        QVERIFY(note.load(fpath));
+        QCOMPARE(note.title(), QStringLiteral("other"));
+        note.setcount(5);
+    }
+
+    Note loaded;
+    QVERIFY(loaded.enableJournal(fpath));
+    QVERIFY(loaded.load(fpath));
+    QCOMPARE(loaded.title(), QStringLiteral("other"));
+    QCOMPARE(loaded.count(), 5);
+}
+
+QTEST_MAIN(tst_QJsonJournal)
+
+#include "tst_qjsonjournal.moc"
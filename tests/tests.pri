@@ -0,0 +1,10 @@
+# Shared settings of the test projects.
+
+QT += qml testlib
+QT -= gui
+CONFIG += console c++11 testcase
+CONFIG -= app_bundle
+
+include(../QJsonHelper.pri)
+
+INCLUDEPATH += $$PWD/..
@@ -0,0 +1,9 @@
+# QTest unit tests, one executable per test.
+#
+#   qmake && make && make check
+
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    qjsonbase64 \
+    qjsonjournal